@@ -1,60 +1,277 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
 #include <stack>
 #include <queue>
 #include <stdexcept>
+#include <unordered_set>
+#include <vector>
 
 namespace DataStructures
 {
     template <class T>
+    class WeightedSearchTree;
+
+    template <class T, class Augmentation>
+    class TreeDiff;
+
+    template <class T, class Augmentation>
+    class CheckpointStore;
+
+    template <class T, class Augmentation>
+    class ParallelImageLoader;
+
+    template <class T, class Augmentation>
+    class Transaction;
+
+    // per node fields an AVLTree can keep on top of the ones balancing needs, the tree's Augmentation parameter picks them at compile time
+    // every kept field costs its bytes in every node whether or not the mode using it is switched on, so the default keeps none of them,
+    // a node of AVLTree<long long> takes 48 bytes then and 80 with every field, a tree that needs some derives its own policy, e.g.
+    // struct Hashed : NoAugmentation { static const bool hashes = true; };
+    struct NoAugmentation
+    {
+        static const bool threaded = false;          // next links, an iterator increment follows one pointer instead of climbing the tree, 8 bytes
+        static const bool accessCounts = false;      // find() hit counts, needed by setAdaptive(), 4 bytes
+        static const bool hashes = false;            // subtree hashes, needed by setHashing(), rootHash(), rangeHash() and the fast TreeDiff, 8 bytes
+        static const bool checkpoints = false;       // records of the last checkpoint, needed by CheckpointStore, 8 bytes
+        static const bool sizes = false;             // subtree sizes, needed by setCounting(), without them estimateRangeCount() estimates and sample() scans, 8 bytes
+    };
+
+    struct FullAugmentation                          // every optional field
+    {
+        static const bool threaded = true;
+        static const bool accessCounts = true;
+        static const bool hashes = true;
+        static const bool checkpoints = true;
+        static const bool sizes = true;
+    };
+
+    namespace AVLTreeFields                          // the optional node fields, each is an empty base of the node when its augmentation is off
+    {
+        template <class Field, bool kept>
+        struct Optional : Field {};
+
+        template <class Field>
+        struct Optional<Field, false> {};
+
+        template <class Node>
+        struct Next { Node* next = nullptr; };                      // node holding the next larger value, null for the largest, rotations keep the order so only insert and remove change it
+        struct SubtreeHash { std::uint64_t subtreeHash = 0; };      // sum of the value hashes of the subtree, only kept while hashing is on
+        struct CheckpointRef { std::uint64_t checkpointRef = 0; };  // record of this subtree in the last checkpoint, 0 while the subtree has changes not checkpointed yet
+        struct SubtreeSize { std::size_t subtreeSize = 0; };        // number of nodes in the subtree, only kept while counting is on
+        struct AccessCount { std::uint32_t accessCount = 0; };      // decayed number of find() hits, only counted in adaptive mode
+    }
+
+    template <class T, class Augmentation = NoAugmentation>
     class AVLTree
     {
-        struct Node
+        friend class WeightedSearchTree<T>;                  // builds its nodes directly
+        friend class TreeDiff<T, Augmentation>;              // compares subtree hashes directly
+        friend class CheckpointStore<T, Augmentation>;       // writes and restores nodes directly
+        friend class ParallelImageLoader<T, Augmentation>;   // builds subtrees on several threads
+        friend class Transaction<T, Augmentation>;           // links and unlinks nodes it allocated before its first change
+
+        struct Node :
+            AVLTreeFields::Optional<AVLTreeFields::Next<Node>, Augmentation::threaded>,
+            AVLTreeFields::Optional<AVLTreeFields::SubtreeHash, Augmentation::hashes>,
+            AVLTreeFields::Optional<AVLTreeFields::CheckpointRef, Augmentation::checkpoints>,
+            AVLTreeFields::Optional<AVLTreeFields::SubtreeSize, Augmentation::sizes>,
+            AVLTreeFields::Optional<AVLTreeFields::AccessCount, Augmentation::accessCounts>
         {
+            int balanceFactor;  // balance factor of current node, will be in the range -2 - 2, adaptive lifts can relax it by one, first so it packs with accessCount
             T value;            // must be comparable
             Node* parent;       // pointer to parent, null if root node
             Node* left;         // pointer to left child, null if leaf node
             Node* right;        // pointer to right child, null if leaf node
 
             std::size_t height; // height of the node in the tree, 0 if leaf node
-            int balanceFactor;  // balance factor of current node, will be in the range -2 - 2
 
             // constructor
             // MUST be passed a value, parent, left, and right pointers default to nullptr if not passed
-            // height and balanceFactor are set to zero upon every creation
+            // height and balanceFactor are set to zero upon every creation, the kept optional fields start at zero or nullptr
             Node(T i_value, Node* i_parent=nullptr, Node* i_left=nullptr, Node* i_right=nullptr) :
-                value{i_value}, parent{i_parent}, left{i_left}, right{i_right}, height{0}, balanceFactor{0}
+                balanceFactor{0}, value{i_value}, parent{i_parent}, left{i_left}, right{i_right}, height{0}
             {}
         };
 
         std::size_t m_size; // size of the tree, starts at 0
         Node* m_root;       // pointer to the root node, if tree is empty m_root is nullptr
+        Node* m_rightmost;  // node holding the largest value, nullptr if the tree is empty or it is not known yet
+
+        bool m_adaptive;                   // if true find() hits are counted and hot nodes are rotated toward the root
+        std::size_t m_decayInterval;       // minimum number of counted hits between two halvings of every access count
+        std::size_t m_accessesSinceDecay;  // hits counted since the access counts were last halved
+
+        bool m_hashing;                    // if true every node keeps the hash of its subtree's values up to date
+        bool m_counting;                   // if true every node keeps the size of its subtree up to date
+
+        std::uint64_t m_id;                // identifies this tree to cursors, unique within the process and unlikely to repeat across processes
+        std::uint64_t m_modifications;     // bumped by every call that adds or frees nodes
 
         public:
 
+        class ConstIterator                             // in order iterator over the tree's values, follows next links in a threaded tree and climbs parents otherwise
+        {
+            friend class AVLTree;
+
+            const Node* m_node;                         // current node, nullptr once past the largest value
+
+            explicit ConstIterator(const Node* node) : m_node{node} {}
+
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            ConstIterator() : m_node{nullptr} {}
+
+            const T& operator*() const { return m_node->value; }
+            const T* operator->() const { return &(m_node->value); }
+
+            ConstIterator& operator++();                // moves to the next larger value
+            ConstIterator operator++(int);
+
+            bool operator==(const ConstIterator& other) const { return m_node == other.m_node; }
+            bool operator!=(const ConstIterator& other) const { return m_node != other.m_node; }
+        };
+
+        struct Cursor                                   // position of a paginated scan, plain data so it can be stored between requests
+        {
+            T lastKey;                                  // last value returned, meaningless until started
+            bool started;                               // false until the first page was returned
+            bool exhausted;                             // true once the last value was returned
+            std::uint64_t treeId;                       // tree that returned the last page
+            std::uint64_t modification;                 // that tree's modification count at the time
+            std::uintptr_t node;                        // node holding lastKey, only trusted while treeId and modification still match
+        };
+
         AVLTree();                                      // constructor
-        AVLTree(const AVLTree<T>&) = delete;            // copy constructor disabled
+        AVLTree(const AVLTree&) = delete;               // copy constructor disabled
         ~AVLTree();                                     // destructor
 
         T* insert(const T&);                            // insert an element into the tree, returns a pointer to an element if it already exists, otherwise returns nullptr
+        T* insert(const T&, T*& inserted);              // same as insert(), also sets inserted to the new element, or to nullptr if the value already existed
         T remove(const T&);                             // remove an element from the tree, returns the value removed, if it does not exist an exception is thrown
 
         T* find(const T&);                              // trys to find an element given a value, if found it returns a pointer to the element, if not returns nullptr
         const T* find(const T&) const;                  // const version of find
 
+        void findSortedBatch(const std::vector<T>& sortedKeys, std::vector<T*>& results);             // finds every key of a sorted batch in one traversal, results[i] is set like find(sortedKeys[i]) would return
+        void findSortedBatch(const std::vector<T>& sortedKeys, std::vector<const T*>& results) const; // const version of findSortedBatch
+
+        void clear();                                   // removes every element
+        void buildSorted(const std::vector<T>& sortedValues); // replaces the contents with the given strictly increasing values in O(n), the tree is perfectly balanced, throws if the values are not strictly increasing
+
         bool empty() const;                             // returns true if the tree is empty, false if not
         std::size_t size() const { return m_size; }     // returns the size of the tree
 
         T* root();                                      // returns the root node pointer
         const T* root() const;                          // const version of root() 
 
+        void setAdaptive(bool enabled, std::size_t decayInterval = 65536); // in adaptive mode every hit of the non const find() counts an access, and a node hit more than twice as often as its parent
+                                                                           // is rotated above it, lifts may leave a balance factor of 2, counts are halved every max(decayInterval, size()) hits
+        bool adaptive() const { return m_adaptive; }    // returns true if adaptive mode is on
+        std::size_t searchDepth(const T&) const;        // returns the number of nodes a search for the value visits
+
+        void setHashing(bool enabled);                  // while hashing is on every node keeps the sum of its subtree's value hashes, turning it on hashes the whole tree once
+        bool hashing() const { return m_hashing; }      // returns true if hashing is on
+        std::uint64_t rootHash() const;                 // returns the hash of every value, equal sets give equal hashes whatever the tree's shape, throws if hashing is off
+        std::uint64_t rangeHash(const T& low, const T& high) const; // returns the hash of the values in [low, high] in O(log n), throws if hashing is off
+
+        void setCounting(bool enabled);                 // while counting is on every node keeps the size of its subtree, turning it on counts the whole tree once
+        bool counting() const { return m_counting; }    // returns true if counting is on
+        std::size_t estimateRangeCount(const T& low, const T& high) const; // returns the number of values in [low, high] in O(log n), exact while counting is on,
+                                                                           // otherwise every subtree is assumed to hold as many values as its height suggests for a tree of size()
+        template <class Generator>
+        std::vector<T> sample(std::size_t count, Generator& generator) const; // returns count values drawn uniformly without replacement in increasing order, every value if count >= size(),
+                                                                              // O(count log n) while counting is on, otherwise one O(n) pass over the values
+
+        ConstIterator begin() const;                    // returns an iterator to the smallest value
+        ConstIterator end() const;                      // returns the past the end iterator
+        ConstIterator lowerBound(const T&) const;       // returns an iterator to the first value not less than the given value
+
+        Cursor cursor() const;                          // returns a cursor positioned before the smallest value
+        std::vector<T> resume(Cursor&, std::size_t count) const; // returns the next count values after the cursor and moves it past them, O(1) to restart
+                                                                 // if the tree was not modified since the cursor was last moved, O(log n) otherwise
+        std::uint64_t modifications() const { return m_modifications; } // returns the number of modifications, for cursors and caches
+
         private:
 
-        std::stack<Node*> stackNodes(const T& value);   // trys to find matching node given a value, but every node that is iterated through is added to a stack
+        static const std::size_t s_maxPath = 128;       // longest root to leaf path plus its nullptr, with no node more than s_liftSlack out of balance 2^64 nodes need height 115
+
+        struct PathBuffer                               // fixed storage under the path stack, so insert() and remove() allocate nothing but the new node
+        {
+            typedef Node* value_type;
+            typedef Node*& reference;
+            typedef Node* const& const_reference;
+            typedef std::size_t size_type;
+
+            Node* nodes[s_maxPath];
+            size_type count;
+
+            PathBuffer() : count{0} {}                  // leaves nodes uninitialized, a value initialized stack would otherwise zero them on every call
+
+            bool empty() const { return count == 0; }
+            size_type size() const { return count; }
+            reference back() { return nodes[count - 1]; }
+            const_reference back() const { return nodes[count - 1]; }
+            void push_back(Node* node) { nodes[count++] = node; }
+            void pop_back() { --count; }
+        };
+
+        typedef std::stack<Node*, PathBuffer> Path;
+
+        Path stackNodes(const T& value);                // trys to find matching node given a value, but every node that is iterated through is added to a stack
                                                         // if matching node is found, the stack is returned, the top most element being the node with the matching value
                                                         // if no matching node is found, a stack will still be returned, but the top most element would be nullptr
 
 
-        void unstackNodes(std::stack<Node*>&);          // unstacks the given stack of node pointers, updating and balancing each node as it is unstacked
+        void unstackNodes(Path&);                       // unstacks the given stack of node pointers, updating and balancing each node as it is unstacked
+
+        template <class MakeNode>
+        T* insertNode(const T& value, T*& inserted, MakeNode makeNode); // insert() with the node returned by makeNode(), which is only called once the value is known to be missing
+        void unlinkNode(Node*, Path&);                  // takes the node at the top of the path out of the tree and rebalances the path, the caller deletes the node
+
+        void attach(Node*);                             // links a new node whose value is not in the tree, for Transaction, allocates nothing
+        Node* detach(const T&);                         // unlinks the value's node without deleting it or copying its value, nullptr if missing, for Transaction, allocates nothing
+
+        void append(Node*);                             // adds a node larger than every other one as the right child of m_rightmost, then updates and balances the right spine
+
+        template <class Pointer>
+        static void batchNodes(Node*, const T* first, const T* last, Pointer* results); // splits the sorted keys around the node's value, recursing only into subtrees that still have keys
+
+        void recordAccess(Node*);                       // counts a find() hit, decaying the counts when it is time and lifting the node if it is hotter than its parent
+        void liftNode(Node*);                           // rotates the node above its parent if no node is left more than s_liftSlack out of balance
+        void decayAccessCounts();                       // halves the access count of every node
+
+        static int heightOf(const Node*);               // returns the height of the node, -1 for nullptr
+
+        static std::uint64_t nextId();                  // returns a new tree id
+
+        static std::uint64_t valueHash(const T&);       // returns the well mixed hash of one value
+        static std::uint64_t hashOf(const Node*);       // returns the node's subtree hash, 0 for nullptr
+        std::uint64_t prefixHash(const T& bound, bool inclusive) const; // returns the hash of the values below bound, or up to it if inclusive
+
+        double rankEstimate(const T& bound, bool inclusive) const;     // returns the number of values below bound, or up to it if inclusive, estimated unless counting is on
+        const Node* nodeAt(std::size_t rank) const;                    // returns the node holding the value with rank smaller values, counting must be on
+        static std::size_t sizeOf(const Node*);                        // returns the node's subtree size, 0 for nullptr
+
+        Node* buildNodes(const T* first, const T* last, Node* parent, Node*& previous); // builds a balanced subtree of the sorted values around their middle, returns its root
+                                                                                         // previous is the node before the first value, it is linked to the new nodes and left at the last one
+        void relink();                                  // sets the next link of every node, for builders that do not create the nodes in order
+        static Node* predecessorOf(Node*);              // returns the node holding the next smaller value, nullptr for the smallest
+
+        static const int s_liftSlack = 2;               // largest balance factor a lift may leave behind, insert() and remove() rebalance such nodes when they pass through them
 
         void update(Node*);                             // updates the given nodes heigh and balance factor
         void balance(Node*);                            // balances the given node
@@ -62,50 +279,69 @@ namespace DataStructures
         void rightRotation(Node*);                      // does a right rotation on a given node
         void leftRotation(Node*);                       // does a left rotation on a given node
 
-        void leafRemove(Node*);                         // removes a leaf node, assumes caller has passed a leaf node
-        void oneSubtreeRemove(Node*);                   // removes a node that has one subtree, assumes caller has passed such a node
-        void twoSubtreeRemove(Node*);                   // removes a node that has two subtrees, assumes caller ahs passed such a node
+        void leafRemove(Node*);                         // unlinks a leaf node, assumes caller has passed a leaf node, the caller deletes it
+        void oneSubtreeRemove(Node*);                   // unlinks a node that has one subtree, assumes caller has passed such a node, the caller deletes it
+        void twoSubtreeRemove(Node*, Path&);            // unlinks a node that has two subtrees, assumes caller ahs passed such a node and the stack of its path from the root
+                                                          // the successor node is moved into its place rather than its value, so pointers to values stay valid until their own value is removed
 
     };
 
-    template <typename T>
-    AVLTree<T>::AVLTree() : m_size{0}, m_root{nullptr}   // constructor start //  
+    template <typename T, typename Augmentation>
+    AVLTree<T, Augmentation>::AVLTree() : m_size{0}, m_root{nullptr}, m_rightmost{nullptr}, // constructor start //  
+        m_adaptive{false}, m_decayInterval{0}, m_accessesSinceDecay{0}, m_hashing{false}, m_counting{false},
+        m_id{nextId()}, m_modifications{0}
     {}                                                   // constructor end //
 
-    template <typename T>
-    AVLTree<T>::~AVLTree()                               // deconstructor start // 
+    template <typename T, typename Augmentation>
+    AVLTree<T, Augmentation>::~AVLTree()                 // deconstructor start // 
     {
-        if(m_root == nullptr)                            // empty tree condition
-            return;
-
-        std::queue<Node*> queue;
-        queue.push(m_root);                              // add root to the queue
-
-        while(!queue.empty())                            // while queue is not empty
-        {
-            Node* current = queue.front();       
+        clear();
+    }                                                    // deconstructor end //
 
-            if(current->left != nullptr)
-                queue.push(current->left);               // add the current node's left child to the queue
+    template <typename T, typename Augmentation>
+    T* AVLTree<T, Augmentation>::insert(const T& newValue)      // insert function start //
+    {
+        T* inserted;
+        return insert(newValue, inserted);
+    }                                                           // insert function end //
 
-            if(current->right != nullptr)
-                queue.push(current->right);              // add the current nodes right child to the queue
+    template <typename T, typename Augmentation>
+    T* AVLTree<T, Augmentation>::insert(const T& newValue, T*& inserted) // reporting insert function start //
+    {
+        return insertNode(newValue, inserted, [&newValue] { return new Node{newValue}; });
+    }                                                           // reporting insert function end //
 
-            queue.pop();                                 // pop the current element off the queue
-            delete current;                              // delete the current element
-        }
-    }                                                    // deconstructor end //
+    template <typename T, typename Augmentation>
+    template <class MakeNode>
+    T* AVLTree<T, Augmentation>::insertNode(const T& newValue, T*& inserted, MakeNode makeNode)
+    {                                                           // insertNode function start //
+        inserted = nullptr;
 
-    template <typename T>
-    T* AVLTree<T>::insert(const T& newValue)                    // insert function start //
-    {
         if(m_root == nullptr)                                   // empty tree condition
         {
-            m_root = new Node{newValue};                        // set the root to the new node
+            m_root = makeNode();                                // set the root to the new node
+            inserted = &(m_root->value);
+            update(m_root);                                     // fills in the augmentations of a leaf
+            m_rightmost = m_root;
+            ++m_size;                                           // increment the size
+            ++m_modifications;
             return nullptr;                                     // return nullptr for successful insertion
         }
 
-        std::stack<Node*> stack{stackNodes(newValue)};
+        if(m_rightmost == nullptr)                              // forgotten by remove() or by a bulk build, find it again once
+            for(m_rightmost = m_root; m_rightmost->right != nullptr; m_rightmost = m_rightmost->right);
+
+        if(m_rightmost->value < newValue)                       // increasing keys skip the search, the new node goes right of the largest one
+        {
+            append(makeNode());
+            inserted = &(m_rightmost->value);                   // append() made the new node the largest
+            return nullptr;
+        }
+
+        if(!(newValue < m_rightmost->value))                    // equal to the largest value
+            return &(m_rightmost->value);
+
+        Path stack{stackNodes(newValue)};
 
         if(stack.top() != nullptr)                              // if value already exists
             return &(stack.top()->value);                       // return pointer to its value
@@ -113,27 +349,36 @@ namespace DataStructures
         stack.pop();                                            // top most node is nullptr so pop it off
         Node* parentNode = stack.top();                         // the parent node of new node is the top most node on the stack
 
+        Node* newNode = makeNode();
+        inserted = &(newNode->value);                           // rotations below move nodes, never values
+
         if(parentNode->value > newValue)                        // value is less than parent, making it the left child
-        {
-            parentNode->left = new Node{newValue};
-            parentNode->left->parent = parentNode;              // set the child's parent to parentNode
-        }
+            parentNode->left = newNode;
 
         else if(parentNode->value < newValue)                   // value is greater than the parent, making it the right child
+            parentNode->right = newNode;
+
+        newNode->parent = parentNode;                           // set the child's parent to parentNode
+        update(newNode);
+
+        if constexpr(Augmentation::threaded)                    // splice the new node into the order, a new smallest value comes before parentNode
         {
-            parentNode->right = new Node{newValue};
-            parentNode->right->parent = parentNode;             // set the child's parent to parentNode
+            Node* predecessor = predecessorOf(newNode);
+            newNode->next = predecessor == nullptr ? parentNode : predecessor->next;
+            if(predecessor != nullptr)
+                predecessor->next = newNode;
         }
 
         unstackNodes(stack);                                    // update and balance nodes in the stack
         ++m_size;                                               // increment the size
+        ++m_modifications;
         return nullptr;                                         // return nullptr for a successful insertion
-    }                                                           // insert function end //
+    }                                                           // insertNode function end //
 
-    template <typename T>
-    T AVLTree<T>::remove(const T& value)                                           // remove function start //
+    template <typename T, typename Augmentation>
+    T AVLTree<T, Augmentation>::remove(const T& value)                             // remove function start //
     {
-        std::stack<Node*> stack{stackNodes(value)};
+        Path stack{stackNodes(value)};
 
         Node* removingNode = stack.top();
 
@@ -144,8 +389,29 @@ namespace DataStructures
         
         T nodeValue = removingNode->value;                                         // save the nodes value to return later
 
+        unlinkNode(removingNode, stack);
+        delete removingNode;                                                       // delete the node
+        return nodeValue;                                                          // return the removed nodes value
+    }                                                                              // remove function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::unlinkNode(Node* removingNode, Path& stack)    // unlinkNode function start //
+    {
+        if(removingNode == m_rightmost)                                            // the next insert looks for the new largest value
+            m_rightmost = nullptr;
+
+        if constexpr(Augmentation::threaded)                                       // unlink the node from the order before the tree changes shape
+        {
+            Node* predecessor = predecessorOf(removingNode);
+            if(predecessor != nullptr)
+                predecessor->next = removingNode->next;
+        }
+
         if(removingNode->left == nullptr && removingNode->right == nullptr)        // the node is a leaf node
+        {
             leafRemove(removingNode);                                              // remove the node
+            stack.pop();                                                           // pop the removed node off the stack
+        }
 
         else if(removingNode->left == nullptr || removingNode->right == nullptr)   // the node has 1 subtree
         {
@@ -154,15 +420,33 @@ namespace DataStructures
         }
         
         else                                                                       // the node has two subtrees
-            twoSubtreeRemove(removingNode);                                        // remove the node 
+            twoSubtreeRemove(removingNode, stack);                                 // remove the node, the stack is fixed up to match the new shape
 
         unstackNodes(stack);                                                       // unstack the nodes, updating and balancing them all
         --m_size;                                                                  // decrement the size
-        return nodeValue;                                                          // return the removed nodes value
-    }                                                                              // remove function end //
+        ++m_modifications;
+    }                                                                              // unlinkNode function end //
 
-    template <typename T>
-    T* AVLTree<T>::find(const T& value)               // find function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::attach(Node* node)                              // attach function start //
+    {
+        T* inserted;
+        insertNode(node->value, inserted, [node] { return node; });               // the caller checked the value is missing, so node is always used
+    }                                                                              // attach function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::Node* AVLTree<T, Augmentation>::detach(const T& value)
+    {                                                                              // detach function start //
+        Path stack{stackNodes(value)};
+        Node* node = stack.top();
+
+        if(node != nullptr)
+            unlinkNode(node, stack);
+        return node;
+    }                                                                              // detach function end //
+
+    template <typename T, typename Augmentation>
+    T* AVLTree<T, Augmentation>::find(const T& value) // find function start //
     {
         Node* currentNode = m_root;
 
@@ -178,12 +462,18 @@ namespace DataStructures
                 currentNode = currentNode->right;    // set the right child of the currentNode to currentNode
 
             else                                     // if currentNode is not nullptr, not less, nor greater, it must be equal, so we found it 
+            {
+                if constexpr(Augmentation::accessCounts)
+                    if(m_adaptive)                   // count the hit, this may rotate the node but never moves its value
+                        recordAccess(currentNode);
+
                 return &(currentNode->value);        // return pointer to the value
+            }
         }
     }                                                // find function end //
 
-    template <typename T>
-    const T* AVLTree<T>::find(const T& value) const  // const find function start //
+    template <typename T, typename Augmentation>
+    const T* AVLTree<T, Augmentation>::find(const T& value) const // const find function start //
     {
         Node* currentNode = m_root;
 
@@ -203,32 +493,430 @@ namespace DataStructures
         }                                                 
     }                                                // const find function end //
 
-    template <typename T>
-    bool AVLTree<T>::empty() const                   // empty function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::findSortedBatch(const std::vector<T>& sortedKeys, std::vector<T*>& results)
+    {                                                                      // findSortedBatch function start //
+        results.resize(sortedKeys.size());
+
+        if(!sortedKeys.empty())
+            batchNodes(m_root, sortedKeys.data(), sortedKeys.data() + sortedKeys.size(), results.data());
+    }                                                                      // findSortedBatch function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::findSortedBatch(const std::vector<T>& sortedKeys, std::vector<const T*>& results) const
+    {                                                                      // const findSortedBatch function start //
+        results.resize(sortedKeys.size());
+
+        if(!sortedKeys.empty())
+            batchNodes(m_root, sortedKeys.data(), sortedKeys.data() + sortedKeys.size(), results.data());
+    }                                                                      // const findSortedBatch function end //
+
+    template <typename T, typename Augmentation>
+    template <class Pointer>
+    void AVLTree<T, Augmentation>::batchNodes(Node* node, const T* first, const T* last, Pointer* results)
+    {                                                                      // batchNodes function start //
+        if(node == nullptr)                                                // none of the remaining keys are in the tree
+        {
+            std::fill(results, results + (last - first), nullptr);
+            return;
+        }
+
+        const T* split = std::lower_bound(first, last, node->value);      // keys before split are less than the node's value
+
+        if(split != first)                                                 // only descend left if some keys belong there
+            batchNodes(node->left, first, split, results);
+
+        Pointer* splitResults = results + (split - first);
+        while(split != last && !(node->value < *split))                    // keys equal to the node's value, the batch may repeat a key
+        {
+            *splitResults = &(node->value);
+            ++split;
+            ++splitResults;
+        }
+
+        if(split != last)                                                  // only descend right if some keys belong there
+            batchNodes(node->right, split, last, splitResults);
+    }                                                                      // batchNodes function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::clear()               // clear function start //
+    {
+        if(m_root == nullptr)                            // empty tree condition
+            return;
+
+        std::queue<Node*> queue;
+        queue.push(m_root);                              // add root to the queue
+
+        while(!queue.empty())                            // while queue is not empty
+        {
+            Node* current = queue.front();       
+
+            if(current->left != nullptr)
+                queue.push(current->left);               // add the current node's left child to the queue
+
+            if(current->right != nullptr)
+                queue.push(current->right);              // add the current nodes right child to the queue
+
+            queue.pop();                                 // pop the current element off the queue
+            delete current;                              // delete the current element
+        }
+
+        m_root = nullptr;
+        m_rightmost = nullptr;
+        m_size = 0;
+        ++m_modifications;
+    }                                                    // clear function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::buildSorted(const std::vector<T>& sortedValues) // buildSorted function start //
+    {
+        for(std::size_t i = 1; i < sortedValues.size(); ++i)                // check before touching the tree
+            if(!(sortedValues[i - 1] < sortedValues[i]))
+                throw std::runtime_error{
+                    "AVLTree buildSorted(), values are not strictly increasing"};
+
+        clear();
+
+        if(sortedValues.empty())
+            return;
+
+        Node* previous = nullptr;
+        m_root = buildNodes(sortedValues.data(), sortedValues.data() + sortedValues.size(), nullptr, previous);
+        m_size = sortedValues.size();
+    }                                                                       // buildSorted function end //
+
+    template <typename T, typename Augmentation>
+    bool AVLTree<T, Augmentation>::empty() const     // empty function start //
     {
         return (m_root == nullptr && m_size == 0);   // if m_root is nullptr and size is 0, the tree is empty
     }                                               // empty function end //
 
-    template <typename T>
-    T* AVLTree<T>::root()         // root function start //
+    template <typename T, typename Augmentation>
+    T* AVLTree<T, Augmentation>::root() // root function start //
     {
         if(m_root == nullptr)     // if root is a nullptr
             return nullptr;       // return nullptr
         return &(m_root->value);  // otherwise return a pointer to the root node's Value
     }                             // root function end // 
 
-    template <typename T>
-    const T* AVLTree<T>::root() const  // const root function start //
+    template <typename T, typename Augmentation>
+    const T* AVLTree<T, Augmentation>::root() const // const root function start //
     {
         if(m_root == nullptr)          // if root is nullptr
             return nullptr;            // return nullptr
         return &(m_root->value);       // otherwise return a pointer to the rood node's value
     }                                  // end of const root function //
 
-    template <typename T>
-    std::stack<typename AVLTree<T>::Node*> AVLTree<T>::stackNodes(const T& value) 
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::setAdaptive(bool enabled, std::size_t decayInterval) // setAdaptive function start //
+    {
+        static_assert(Augmentation::accessCounts, "AVLTree setAdaptive() needs an augmentation that keeps access counts");
+
+        m_adaptive = enabled;
+        m_decayInterval = decayInterval;
+        m_accessesSinceDecay = 0;
+    }                                                                        // setAdaptive function end //
+
+    template <typename T, typename Augmentation>
+    std::size_t AVLTree<T, Augmentation>::searchDepth(const T& value) const  // searchDepth function start //
+    {
+        std::size_t depth = 0;
+
+        for(const Node* currentNode = m_root; currentNode != nullptr; ++depth)
+        {
+            if(currentNode->value > value)
+                currentNode = currentNode->left;
+
+            else if(currentNode->value < value)
+                currentNode = currentNode->right;
+
+            else                                                             // found, count the node itself
+                return depth + 1;
+        }
+
+        return depth;
+    }                                                                        // searchDepth function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::setHashing(bool enabled)                  // setHashing function start //
+    {
+        static_assert(Augmentation::hashes, "AVLTree setHashing() needs an augmentation that keeps subtree hashes");
+
+        if(enabled == m_hashing)
+            return;
+
+        m_hashing = enabled;
+
+        if(!enabled || m_root == nullptr)
+            return;
+
+        std::vector<Node*> order;                                            // preorder, so reversing it visits children before parents
+        order.reserve(m_size);
+        order.push_back(m_root);
+
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            if(order[i]->left != nullptr)
+                order.push_back(order[i]->left);
+
+            if(order[i]->right != nullptr)
+                order.push_back(order[i]->right);
+        }
+
+        for(std::size_t i = order.size(); i-- > 0;)
+            order[i]->subtreeHash = valueHash(order[i]->value) + hashOf(order[i]->left) + hashOf(order[i]->right);
+    }                                                                        // setHashing function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::rootHash() const                 // rootHash function start //
+    {
+        static_assert(Augmentation::hashes, "AVLTree rootHash() needs an augmentation that keeps subtree hashes");
+
+        if(!m_hashing)
+            throw std::runtime_error{
+                "AVLTree rootHash(), hashing is not enabled"};
+
+        return hashOf(m_root);
+    }                                                                        // rootHash function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::rangeHash(const T& low, const T& high) const // rangeHash function start //
+    {
+        static_assert(Augmentation::hashes, "AVLTree rangeHash() needs an augmentation that keeps subtree hashes");
+
+        if(!m_hashing)
+            throw std::runtime_error{
+                "AVLTree rangeHash(), hashing is not enabled"};
+
+        if(high < low)
+            return 0;
+
+        return prefixHash(high, true) - prefixHash(low, false);              // wraps like the sums themselves
+    }                                                                        // rangeHash function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::setCounting(bool enabled)                 // setCounting function start //
+    {
+        static_assert(Augmentation::sizes, "AVLTree setCounting() needs an augmentation that keeps subtree sizes");
+
+        if(enabled == m_counting)
+            return;
+
+        m_counting = enabled;
+
+        if(!enabled || m_root == nullptr)
+            return;
+
+        std::vector<Node*> order;                                            // preorder, so reversing it visits children before parents
+        order.reserve(m_size);
+        order.push_back(m_root);
+
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            if(order[i]->left != nullptr)
+                order.push_back(order[i]->left);
+
+            if(order[i]->right != nullptr)
+                order.push_back(order[i]->right);
+        }
+
+        for(std::size_t i = order.size(); i-- > 0;)
+            order[i]->subtreeSize = 1 + sizeOf(order[i]->left) + sizeOf(order[i]->right);
+    }                                                                        // setCounting function end //
+
+    template <typename T, typename Augmentation>
+    std::size_t AVLTree<T, Augmentation>::estimateRangeCount(const T& low, const T& high) const // estimateRangeCount function start //
+    {
+        if(high < low)
+            return 0;
+
+        double count = rankEstimate(high, true) - rankEstimate(low, false);
+        return count <= 0 ? 0 : static_cast<std::size_t>(std::llround(count));
+    }                                                                        // estimateRangeCount function end //
+
+    template <typename T, typename Augmentation>
+    template <class Generator>
+    std::vector<T> AVLTree<T, Augmentation>::sample(std::size_t count, Generator& generator) const // sample function start //
+    {
+        std::vector<T> values;
+
+        if(count >= m_size)
+        {
+            values.assign(begin(), end());
+            return values;
+        }
+
+        values.reserve(count);
+
+        if constexpr(Augmentation::sizes)
+            if(m_counting)
+            {
+                std::unordered_set<std::size_t> chosen;                      // Floyd's algorithm, count distinct ranks with count draws
+                chosen.reserve(count);
+
+                for(std::size_t j = m_size - count; j < m_size; ++j)
+                {
+                    std::size_t rank = std::uniform_int_distribution<std::size_t>{0, j}(generator);
+                    if(!chosen.insert(rank).second)
+                        chosen.insert(j);
+                }
+
+                std::vector<std::size_t> ranks(chosen.begin(), chosen.end());
+                std::sort(ranks.begin(), ranks.end());
+
+                for(std::size_t rank : ranks)
+                    values.push_back(nodeAt(rank)->value);
+
+                return values;
+            }
+
+        std::size_t remaining = m_size;                                      // selection sampling, each value is taken with probability needed / remaining
+
+        for(ConstIterator current = begin(); values.size() < count; ++current, --remaining)
+            if(std::uniform_int_distribution<std::size_t>{0, remaining - 1}(generator) < count - values.size())
+                values.push_back(*current);
+
+        return values;
+    }                                                                        // sample function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::ConstIterator AVLTree<T, Augmentation>::begin() const
+    {                                                     // begin function start //
+        const Node* currentNode = m_root;
+
+        if(currentNode == nullptr)                        // empty tree, begin is end
+            return end();
+
+        while(currentNode->left != nullptr)               // the smallest value is the left most node
+            currentNode = currentNode->left;
+
+        return ConstIterator{currentNode};
+    }                                                     // begin function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::ConstIterator AVLTree<T, Augmentation>::end() const
+    {                                                     // end function start //
+        return ConstIterator{nullptr};
+    }                                                     // end function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::ConstIterator AVLTree<T, Augmentation>::lowerBound(const T& value) const
+    {                                                     // lowerBound function start //
+        const Node* currentNode = m_root;
+        const Node* bound = nullptr;                      // smallest node seen so far that is not less than value
+
+        while(currentNode != nullptr)
+        {
+            if(currentNode->value < value)                // everything left of here is smaller too, go right
+                currentNode = currentNode->right;
+
+            else                                          // a candidate, a smaller one may be in the left subtree
+            {
+                bound = currentNode;
+                currentNode = currentNode->left;
+            }
+        }
+
+        return ConstIterator{bound};
+    }                                                     // lowerBound function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::Cursor AVLTree<T, Augmentation>::cursor() const // cursor function start //
+    {
+        Cursor cursor{};
+        cursor.started = false;
+        cursor.exhausted = false;
+        cursor.treeId = m_id;
+        cursor.modification = m_modifications;
+        cursor.node = 0;
+        return cursor;
+    }                                                                       // cursor function end //
+
+    template <typename T, typename Augmentation>
+    std::vector<T> AVLTree<T, Augmentation>::resume(Cursor& cursor, std::size_t count) const // resume function start //
+    {
+        ConstIterator current;
+
+        if(!cursor.started)
+            current = begin();
+
+        else if(cursor.treeId == m_id && cursor.modification == m_modifications && cursor.node != 0)
+            current = ++ConstIterator{reinterpret_cast<const Node*>(cursor.node)};  // the node is still here, step from it
+
+        else                                                                // search again for the first value after the last one returned
+        {
+            current = lowerBound(cursor.lastKey);
+            if(current != end() && !(cursor.lastKey < *current))
+                ++current;
+        }
+
+        std::vector<T> page;
+        page.reserve(count);
+
+        const Node* last = nullptr;
+        for(; page.size() < count && current != end(); ++current)
+        {
+            page.push_back(*current);
+            last = current.m_node;
+        }
+
+        if(last != nullptr)
+        {
+            cursor.lastKey = last->value;
+            cursor.node = reinterpret_cast<std::uintptr_t>(last);
+            cursor.started = true;
+        }
+
+        cursor.exhausted = current == end();
+        cursor.treeId = m_id;
+        cursor.modification = m_modifications;
+        return page;
+    }                                                                       // resume function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::ConstIterator& AVLTree<T, Augmentation>::ConstIterator::operator++()
+    {                                                     // iterator increment function start //
+        if constexpr(Augmentation::threaded)
+        {
+            m_node = m_node->next;                        // one dependent load per value, no climbing back up the tree
+            return *this;
+        }
+
+        if(m_node->right != nullptr)                      // the next value is the left most node of the right subtree
+        {
+            m_node = m_node->right;
+
+            while(m_node->left != nullptr)
+                m_node = m_node->left;
+        }
+
+        else                                              // otherwise climb until we come up from a left child
+        {
+            const Node* child = m_node;
+            m_node = m_node->parent;
+
+            while(m_node != nullptr && m_node->right == child)
+            {
+                child = m_node;
+                m_node = m_node->parent;
+            }
+        }
+
+        return *this;
+    }                                                     // iterator increment function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::ConstIterator AVLTree<T, Augmentation>::ConstIterator::operator++(int)
+    {                                                     // iterator post increment function start //
+        ConstIterator previous{*this};
+        ++(*this);
+        return previous;
+    }                                                     // iterator post increment function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::Path AVLTree<T, Augmentation>::stackNodes(const T& value)
     {                                                 // stackNodes function start //
-        std::stack<Node*> stack;                      // create a stack of Node*
+        Path stack;                                   // create a stack of Node*
         stack.push(m_root);                           // add the root Node to the stack
 
         while(true)
@@ -249,8 +937,8 @@ namespace DataStructures
         }
     }                                                 // stackNodes function end //
 
-    template <typename T>
-    void AVLTree<T>::unstackNodes(std::stack<Node*>& stack) // unstackNodes function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::unstackNodes(Path& stack)              // unstackNodes function start //
     {
         while(!stack.empty())                               // while the stack is not empty 
         {
@@ -269,8 +957,338 @@ namespace DataStructures
         }
     }                                                       // unstackNodes function end //
 
-    template <typename T>
-    void AVLTree<T>::update(Node* node)                        // update function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::append(Node* node)       // append function start //
+    {
+        Node* parentNode = m_rightmost;
+
+        node->parent = parentNode;
+        parentNode->right = node;                               // the largest node never has a right child
+        if constexpr(Augmentation::threaded)
+            parentNode->next = parentNode->right;
+        m_rightmost = parentNode->right;
+        update(m_rightmost);
+
+        for(Node* currentNode = parentNode; currentNode != nullptr;)    // the ancestors of the largest node are the right spine, no stack is needed
+        {
+            Node* spineParent = currentNode->parent;
+            std::size_t oldHeight = currentNode->height;
+            bool wasDirty = true;                               // then every ancestor is already dirty too
+            if constexpr(Augmentation::checkpoints)
+                wasDirty = currentNode->checkpointRef == 0;
+
+            update(currentNode);
+            balance(currentNode);                               // a rotation moves currentNode down, the subtree gets a new top
+
+            Node* top = spineParent == nullptr ? m_root : spineParent->right;
+            if(!m_hashing && !m_counting && wasDirty && top->height == oldHeight)  // nothing the ancestors keep can have changed
+                break;
+
+            currentNode = spineParent;
+        }
+
+        ++m_size;
+        ++m_modifications;
+    }                                                       // append function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::recordAccess(Node* node)                  // recordAccess function start //
+    {
+        if(node->accessCount != std::numeric_limits<std::uint32_t>::max())                                // saturate rather than wrap
+            ++node->accessCount;
+
+        if(++m_accessesSinceDecay >= std::max(m_decayInterval, m_size))      // at least size() hits between decays keeps the halving pass O(1) amortized
+        {
+            decayAccessCounts();
+            m_accessesSinceDecay = 0;
+        }
+
+        liftNode(node);
+    }                                                                        // recordAccess function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::liftNode(Node* node)                      // liftNode function start //
+    {
+        Node* parent = node->parent;
+
+        if(parent == nullptr || node->accessCount / 2 <= parent->accessCount)    // already at the root, or not clearly hotter than its parent,
+            return;                                                              // the margin keeps two similar nodes from rotating back and forth
+
+        Node* outer = parent->left == node ? node->left : node->right;       // stays under node after the rotation
+        Node* inner = parent->left == node ? node->right : node->left;       // moves over to parent
+        Node* sibling = parent->left == node ? parent->right : parent->left; // stays under parent
+
+        int parentHeight = std::max(heightOf(inner), heightOf(sibling)) + 1; // heights after the rotation
+        int nodeHeight = std::max(heightOf(outer), parentHeight) + 1;
+
+        if(heightOf(inner) - heightOf(sibling) > s_liftSlack || heightOf(sibling) - heightOf(inner) > s_liftSlack)   // parent would be too far out of balance
+            return;
+
+        if(parentHeight - heightOf(outer) > s_liftSlack || heightOf(outer) - parentHeight > s_liftSlack)             // node would be too far out of balance
+            return;
+
+        int newHeight = nodeHeight;                                          // check the ancestors with the height they would see
+        Node* child = parent;
+
+        for(Node* ancestor = parent->parent; ancestor != nullptr && newHeight != heightOf(child); ancestor = ancestor->parent)
+        {
+            int other = heightOf(ancestor->left == child ? ancestor->right : ancestor->left);
+
+            if(newHeight - other > s_liftSlack || other - newHeight > s_liftSlack) // this ancestor would be too far out of balance
+                return;
+
+            newHeight = std::max(newHeight, other) + 1;
+            child = ancestor;
+        }
+
+        if(parent->left == node)                                             // the rotation updates both heights and balance factors
+            rightRotation(parent);
+        else
+            leftRotation(parent);
+
+        for(Node* ancestor = node->parent; ancestor != nullptr; ancestor = ancestor->parent)
+        {
+            std::size_t oldHeight = ancestor->height;
+            update(ancestor);
+
+            if(ancestor->height == oldHeight)                                // heights above here did not change
+                break;
+        }
+
+        if constexpr(Augmentation::checkpoints)
+            for(Node* ancestor = node->parent; ancestor != nullptr; ancestor = ancestor->parent)
+                ancestor->checkpointRef = 0;                                 // a checkpointed subtree below them changed shape, even where heights did not
+    }                                                                        // liftNode function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::decayAccessCounts()                       // decayAccessCounts function start //
+    {
+        if(m_root == nullptr)
+            return;
+
+        std::stack<Node*> stack;
+        stack.push(m_root);
+
+        while(!stack.empty())
+        {
+            Node* current = stack.top();
+            stack.pop();
+
+            current->accessCount /= 2;                                       // old hits count half as much as new ones
+
+            if(current->left != nullptr)
+                stack.push(current->left);
+
+            if(current->right != nullptr)
+                stack.push(current->right);
+        }
+    }                                                                        // decayAccessCounts function end //
+
+    template <typename T, typename Augmentation>
+    int AVLTree<T, Augmentation>::heightOf(const Node* node)                 // heightOf function start //
+    {
+        if(node == nullptr)
+            return -1;
+        return static_cast<int>(node->height);
+    }                                                                        // heightOf function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::Node* AVLTree<T, Augmentation>::buildNodes(const T* first, const T* last, Node* parent, Node*& previous)
+    {                                                                       // buildNodes function start //
+        if(first == last)
+            return nullptr;
+
+        const T* middle = first + (last - first) / 2;                       // halves differ by at most one value, so every node is balanced
+        Node* node = new Node{*middle, parent};
+
+        node->left = buildNodes(first, middle, node, previous);
+
+        if constexpr(Augmentation::threaded)
+            if(previous != nullptr)                                         // every smaller value is built, link the largest of them here
+                previous->next = node;
+        previous = node;
+
+        node->right = buildNodes(middle + 1, last, node, previous);
+        update(node);
+
+        return node;
+    }                                                                       // buildNodes function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::relink()                                 // relink function start //
+    {
+        if constexpr(Augmentation::threaded)                                // without next links there is nothing to relink
+        {
+            std::vector<Node*> stack;                                       // in order walk, the left spine of every subtree is pushed before it is visited
+            Node* previous = nullptr;
+
+            for(Node* currentNode = m_root; currentNode != nullptr || !stack.empty();)
+            {
+                for(; currentNode != nullptr; currentNode = currentNode->left)
+                    stack.push_back(currentNode);
+
+                currentNode = stack.back();
+                stack.pop_back();
+
+                if(previous != nullptr)
+                    previous->next = currentNode;
+                previous = currentNode;
+
+                currentNode = currentNode->right;
+            }
+
+            if(previous != nullptr)
+                previous->next = nullptr;
+        }
+    }                                                                       // relink function end //
+
+    template <typename T, typename Augmentation>
+    typename AVLTree<T, Augmentation>::Node* AVLTree<T, Augmentation>::predecessorOf(Node* node) // predecessorOf function start //
+    {
+        if(node->left != nullptr)                                           // the right most node of the left subtree
+        {
+            node = node->left;
+
+            while(node->right != nullptr)
+                node = node->right;
+
+            return node;
+        }
+
+        Node* child = node;                                                 // otherwise the first ancestor reached from its right side
+        node = node->parent;
+
+        while(node != nullptr && node->left == child)
+        {
+            child = node;
+            node = node->parent;
+        }
+
+        return node;
+    }                                                                       // predecessorOf function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::nextId()                         // nextId function start //
+    {
+        static std::atomic<std::uint64_t> next{(static_cast<std::uint64_t>(std::random_device{}()) << 32) | 1}; // random start, a cursor from another process will not match a local tree
+        return next.fetch_add(1);
+    }                                                                        // nextId function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::valueHash(const T& value)        // valueHash function start //
+    {
+        std::uint64_t hash = static_cast<std::uint64_t>(std::hash<T>{}(value)) + 0x9e3779b97f4a7c15; // std::hash is often the identity, finish it like splitmix64,
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;                                           // the added constant keeps 0 from hashing to 0 and vanishing from the sums
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+        return hash ^ (hash >> 31);
+    }                                                                        // valueHash function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::hashOf(const Node* node)         // hashOf function start //
+    {
+        if(node == nullptr)
+            return 0;
+        return node->subtreeHash;
+    }                                                                        // hashOf function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t AVLTree<T, Augmentation>::prefixHash(const T& bound, bool inclusive) const // prefixHash function start //
+    {
+        std::uint64_t hash = 0;
+
+        for(const Node* currentNode = m_root; currentNode != nullptr;)
+        {
+            if(currentNode->value < bound || (inclusive && !(bound < currentNode->value)))  // the node and its left subtree are all below the bound
+            {
+                hash += valueHash(currentNode->value) + hashOf(currentNode->left);
+                currentNode = currentNode->right;
+            }
+            else
+                currentNode = currentNode->left;
+        }
+
+        return hash;
+    }                                                                        // prefixHash function end //
+
+    template <typename T, typename Augmentation>
+    double AVLTree<T, Augmentation>::rankEstimate(const T& bound, bool inclusive) const // rankEstimate function start //
+    {
+        if(m_root == nullptr)
+            return 0;
+
+        double perLevel = std::log(static_cast<double>(m_size) + 1) / static_cast<double>(m_root->height + 1); // a subtree of height h is weighted
+                                                                                                                 // (size() + 1)^((h + 1) / (root height + 1)) - 1
+        double size = static_cast<double>(m_size);                           // estimated size of the current subtree, its values are split between the
+        double rank = 0;                                                     // children by their weights, so the estimates always add up to size()
+
+        for(const Node* currentNode = m_root; currentNode != nullptr;)
+        {
+            double leftSize = 0;
+            bool counted = false;
+
+            if constexpr(Augmentation::sizes)
+                if(m_counting)
+                {
+                    leftSize = static_cast<double>(sizeOf(currentNode->left));
+                    counted = true;
+                }
+
+            if(!counted && currentNode->left != nullptr)
+            {
+                double leftWeight = std::exp(static_cast<double>(currentNode->left->height + 1) * perLevel) - 1;
+                double rightWeight = currentNode->right == nullptr ? 0 : std::exp(static_cast<double>(currentNode->right->height + 1) * perLevel) - 1;
+                leftSize = (size - 1) * leftWeight / (leftWeight + rightWeight);
+            }
+
+            if(currentNode->value < bound || (inclusive && !(bound < currentNode->value)))  // the node and its left subtree are all below the bound
+            {
+                rank += leftSize + 1;
+                size -= leftSize + 1;
+                currentNode = currentNode->right;
+            }
+            else
+            {
+                size = leftSize;
+                currentNode = currentNode->left;
+            }
+        }
+
+        return rank;
+    }                                                                        // rankEstimate function end //
+
+    template <typename T, typename Augmentation>
+    const typename AVLTree<T, Augmentation>::Node* AVLTree<T, Augmentation>::nodeAt(std::size_t rank) const // nodeAt function start //
+    {
+        const Node* currentNode = m_root;
+
+        while(true)
+        {
+            std::size_t leftSize = sizeOf(currentNode->left);
+
+            if(rank < leftSize)
+                currentNode = currentNode->left;
+
+            else if(rank == leftSize)
+                return currentNode;
+
+            else
+            {
+                rank -= leftSize + 1;
+                currentNode = currentNode->right;
+            }
+        }
+    }                                                                        // nodeAt function end //
+
+    template <typename T, typename Augmentation>
+    std::size_t AVLTree<T, Augmentation>::sizeOf(const Node* node)           // sizeOf function start //
+    {
+        if(node == nullptr)
+            return 0;
+        return node->subtreeSize;
+    }                                                                        // sizeOf function end //
+
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::update(Node* node)          // update function start //
     {
         if(node == nullptr)                                    // if passed value is nullptr return
             return;
@@ -291,33 +1309,50 @@ namespace DataStructures
             node->height = leftHeight+1;
 
         node->balanceFactor = (rightHeight+1) - (leftHeight+1); // calculate the balance factor, rightHeight+1 - leftHeight+1
+
+        if constexpr(Augmentation::hashes)
+            if(m_hashing)                                       // a sum of value hashes does not depend on the shape, so rotations keep it valid
+                node->subtreeHash = valueHash(node->value) + hashOf(node->left) + hashOf(node->right);
+
+        if constexpr(Augmentation::sizes)
+            if(m_counting)
+                node->subtreeSize = 1 + sizeOf(node->left) + sizeOf(node->right);
+
+        if constexpr(Augmentation::checkpoints)
+            node->checkpointRef = 0;                            // every change reaches update(), the subtree must be written again
     }                                                           // update function end //
 
-    template <typename T>
-    void AVLTree<T>::balance(Node* node)           // balance function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::balance(Node* node) // balance function start //
     {
         if(node == nullptr)                        // nullptr condition to avoid any segmentatio faults
             return;
 
-        if(node->balanceFactor == -2)              // tree is left heavy
+        if(node->balanceFactor <= -2)              // tree is left heavy
         {
-            if(node->left->balanceFactor == 1)     // left right case
+            if(node->left->balanceFactor > 0)      // left right case
                 leftRotation(node->left);          // left rotation on the passed node's left child
 
             rightRotation(node);                   // right rotation on the node
+            Node* top = node->parent;
+            balance(node);                         // only needed after adaptive lifts, a node demoted from a relaxed subtree can still be unbalanced
+            update(top);
         }
 
-        else if(node->balanceFactor == 2)          // tree is right heavy
+        else if(node->balanceFactor >= 2)          // tree is right heavy
         {
-            if(node->right->balanceFactor == -1)   // right left case
+            if(node->right->balanceFactor < 0)     // right left case
                 rightRotation(node->right);        // do a right rotation with the passed node's right child
 
             leftRotation(node);                    // do right rotation on the node
+            Node* top = node->parent;
+            balance(node);
+            update(top);
         }
     }                                              // balance function end // 
 
-    template <typename T>
-    void AVLTree<T>::rightRotation(Node* A) // rightRotation function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::rightRotation(Node* A) // rightRotation function start //
     {
         if(A == nullptr)                    // if passed node is nullptr return
             return;
@@ -350,8 +1385,8 @@ namespace DataStructures
         update(B);
     }                                       // rightRotation function end //
 
-    template <typename T>
-    void AVLTree<T>::leftRotation(Node* A)  // leftRotation function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::leftRotation(Node* A) // leftRotation function start //
     {
         if(A == nullptr)                    // if passed a nullptr, return
             return;
@@ -385,8 +1420,8 @@ namespace DataStructures
 
     }                                       // leftRotation function end //
 
-    template <typename T>
-    void AVLTree<T>::leafRemove(Node* node)  // leafRemove function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::leafRemove(Node* node) // leafRemove function start //
     {
         if(node == nullptr)                  // nullptr check
             return;
@@ -402,24 +1437,22 @@ namespace DataStructures
                 parent->right = nullptr;     // set parent's right child to nullptr
         }
 
-        delete node;                         // delete the node
+        else                                 // node was the root, the tree is now empty
+            m_root = nullptr;
     }                                        // leafRemove function end // 
 
-    template <typename T>
-    void AVLTree<T>::oneSubtreeRemove(Node* node)  // oneSubtreeRemove function start //
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::oneSubtreeRemove(Node* node) // oneSubtreeRemove function start //
     {
         if(node == nullptr)                        // nullptr check
             return;
         
-        Node* subtree;
+        Node* subtree = node->right;               // subtree is the right child unless node's left child isn't null
         Node* parent = node->parent;
 
         if(node->left != nullptr)                  // if node's left child isn't null subtree is the left child
             subtree = node->left;
 
-        else if(node->right != nullptr)            // if node's right child isn't null subtree is the right child
-            subtree = node->right;
-
         if(parent != nullptr)                      // if parent isn't nullptr
         {
             if(parent->left == node)               // if node was the parent's left child
@@ -429,35 +1462,59 @@ namespace DataStructures
                 parent->right = subtree;           // make the subtree the parent's right child
         }
 
-        subtree->parent = parent;                  // make the subtrees parent the nodes parent
+        else                                       // node was the root, the subtree takes its place
+            m_root = subtree;
 
-        delete node;                               // delete the node
+        subtree->parent = parent;                  // make the subtrees parent the nodes parent
     }                                              // oneSubtreeRemove function end //
 
-    template <typename T>
-    void AVLTree<T>::twoSubtreeRemove(Node* node)
+    template <typename T, typename Augmentation>
+    void AVLTree<T, Augmentation>::twoSubtreeRemove(Node* node, Path& stack)   // twoSubtreeRemove function start //
     {
         if(node == nullptr)
             return;
 
-        std::stack<Node*> stack;
-
-        Node* comparingNode = node->right;
+        stack.pop();                                                            // node is the top of the stack, it leaves the tree
 
-        while(comparingNode->left != nullptr)
-            comparingNode = comparingNode->left;
+        Node* successor = node->right;                                          // the successor is the left most node of the right subtree
 
-        node->value = comparingNode->value;
+        while(successor->left != nullptr)
+            successor = successor->left;
 
-        if(comparingNode->left == nullptr && comparingNode->right == nullptr)
-            leafRemove(comparingNode);
+        Node* successorParent = successor->parent;
 
-        else if(comparingNode->left == nullptr || comparingNode->right == nullptr)
+        if(successorParent != node)                                             // successor is deeper down, its right subtree takes its place
         {
-            oneSubtreeRemove(comparingNode);
-            stack.pop();
+            successorParent->left = successor->right;
+            if(successor->right != nullptr)
+                successor->right->parent = successorParent;
+
+            successor->right = node->right;                                     // successor adopts node's right subtree
+            node->right->parent = successor;
         }
 
-        unstackNodes(stack);
-    }
+        successor->left = node->left;                                           // successor adopts node's left subtree
+        node->left->parent = successor;
+
+        successor->parent = node->parent;                                       // successor takes node's place under node's parent
+
+        if(node->parent == nullptr)
+            m_root = successor;
+
+        else if(node->parent->left == node)
+            node->parent->left = successor;
+
+        else
+            node->parent->right = successor;
+
+        stack.push(successor);                                                  // successor and the path down to its old parent need updating
+
+        for(Node* current = successor->right; successorParent != node && current != nullptr; current = current->left)
+        {
+            stack.push(current);
+
+            if(current == successorParent)
+                break;
+        }
+    }                                                                           // twoSubtreeRemove function end //
 }
@@ -0,0 +1,837 @@
+// benchmark driver, writes a BenchmarkReport of insert, find, remove and scan over shuffled keys,
+// plus the benchmarks behind the numbers quoted for batch lookup, the hybrid index, adaptive balancing,
+// diffs, transactions, the append path and range estimates
+//
+// build: g++ -O2 -std=c++17 -pthread AVLTreeBenchmark.cpp -o AVLTreeBenchmark
+// usage: AVLTreeBenchmark [--size n] [--runs r] [--seed s] [--filter text] [--output report.json]
+// insert, find, scan and remove also print hardware counters per operation where perf_event_open is allowed
+// every benchmark is named like "find/1000000", --filter keeps the benchmarks whose name contains the text
+// two reports are compared with CompareReports
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AVLTree.h"
+#include "BenchmarkReport.h"
+#include "HybridAVLTree.h"
+#include "PerfCounters.h"
+#include "Transaction.h"
+#include "TreeDiff.h"
+
+namespace
+{
+    using namespace DataStructures;
+
+    std::size_t s_allocations = 0;                   // heap allocations so far, the benchmarks are single threaded
+    std::size_t s_liveBytes = 0;                     // bytes requested and not freed yet, without the allocator's own overhead
+    const std::size_t s_header = alignof(std::max_align_t); // every allocation is preceded by its size, so operator delete can subtract it
+    volatile long long s_sink = 0;                   // results are written here so the compiler cannot drop the measured work
+
+    struct Adaptive : NoAugmentation { static const bool accessCounts = true; };
+    struct Hashed : NoAugmentation { static const bool hashes = true; };
+    struct Counted : NoAugmentation { static const bool sizes = true; };
+
+    struct Options
+    {
+        std::size_t size = 1000000;                  // elements per tree
+        std::size_t runs = 5;                        // timed repetitions of every benchmark
+        std::uint64_t seed = 42;                     // seed of every key order, so two builds measure the same work
+        std::string filter;                          // runs only benchmarks whose name contains it, every benchmark if empty
+        std::string output = "benchmark.json";       // report file
+    };
+
+    class Benchmarks
+    {
+        Options m_options;
+        BenchmarkReport m_report;
+        PerfCounters m_counters;                     // opened once for the benchmark thread
+
+        public:
+
+        explicit Benchmarks(const Options& options) : m_options{options}, m_report{}, m_counters{} { m_report.hardware = HardwareInfo::current(); }
+
+        void run();                                  // runs every selected benchmark
+        const BenchmarkReport& report() const { return m_report; }
+
+        private:
+
+        bool selected(const std::string& prefix) const;          // returns true if any benchmark starting with prefix matches the filter
+        bool wanted(const std::string& name) const;              // returns true if the benchmark's full name matches the filter
+        std::string named(const std::string& name, std::size_t parameter) const; // returns e.g. "find/1000000"
+
+        template <class Phase>
+        static double timed(std::size_t operations, Phase phase, std::size_t& allocations);  // runs phase once, returns its ns/op and adds its allocations
+
+        static void percentiles(BenchmarkResult&, std::vector<double>& latencies); // fills p50, p90 and p99 from single operation latencies
+        static void accumulate(PerfCounters::Reading& total, const PerfCounters::Reading& run); // adds a run's counts, a counter missing from any run stays unavailable
+
+        void add(BenchmarkResult&, std::size_t operations, std::size_t allocations); // turns the summed allocations into a per operation mean and adds the result
+
+        std::vector<long long> shuffled(std::size_t count, std::uint64_t stream) const; // returns 0..count-1 in a random order
+        std::vector<long long> randomKeys(std::size_t count) const;                      // returns count distinct random 64 bit keys
+
+        template <class Augmentation>
+        void basic(const std::string& suffix);       // insert, find, scan and remove, the suffix tells the layouts apart
+        void sortedBatch();                          // findSortedBatch against find per key
+        void hybrid();                               // HybridAVLTree insert and find against AVLTree
+        void adaptive();                             // zipf distributed finds with and without adaptive balancing
+        void treeDiff();                             // hash guided diff against the linear merge
+        void transactions();                         // transactions of several batch sizes against single locked inserts
+        void append();                               // increasing keys
+        void estimates();                            // range count estimates, exact counts and sampling
+    };
+
+    void Benchmarks::run()                                                                       // run function start //
+    {
+        basic<NoAugmentation>("");
+        basic<FullAugmentation>("_full");
+        sortedBatch();
+        hybrid();
+        adaptive();
+        treeDiff();
+        transactions();
+        append();
+        estimates();
+    }                                                                                            // run function end //
+
+    bool Benchmarks::selected(const std::string& prefix) const                                   // selected function start //
+    {
+        return m_options.filter.empty() || prefix.find(m_options.filter) != std::string::npos
+            || m_options.filter.find(prefix) != std::string::npos;                               // "find/1000" still selects the group starting with "find"
+    }                                                                                            // selected function end //
+
+    bool Benchmarks::wanted(const std::string& name) const                                       // wanted function start //
+    {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }                                                                                            // wanted function end //
+
+    std::string Benchmarks::named(const std::string& name, std::size_t parameter) const          // named function start //
+    {
+        return name + "/" + std::to_string(parameter);
+    }                                                                                            // named function end //
+
+    template <class Phase>
+    double Benchmarks::timed(std::size_t operations, Phase phase, std::size_t& allocations)      // timed function start //
+    {
+        std::size_t allocationsBefore = s_allocations;
+        auto start = std::chrono::steady_clock::now();
+        phase();
+        auto stop = std::chrono::steady_clock::now();
+        allocations += s_allocations - allocationsBefore;
+
+        double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        return nanoseconds / static_cast<double>(operations == 0 ? 1 : operations);
+    }                                                                                            // timed function end //
+
+    void Benchmarks::percentiles(BenchmarkResult& result, std::vector<double>& latencies)        // percentiles function start //
+    {
+        if(latencies.empty())
+            return;
+
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [&latencies](double fraction) { return latencies[static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1))]; };
+
+        result.p50 = at(0.5);
+        result.p90 = at(0.9);
+        result.p99 = at(0.99);
+    }                                                                                            // percentiles function end //
+
+    void Benchmarks::accumulate(PerfCounters::Reading& total, const PerfCounters::Reading& run) // accumulate function start //
+    {
+        bool first = total.operations == 0;
+        total.operations += run.operations;
+
+        for(int i = 0; i < PerfCounters::CounterCount; ++i)
+        {
+            total.values[i] += run.values[i];
+            total.available[i] = run.available[i] && (first || total.available[i]);
+        }
+    }                                                                                            // accumulate function end //
+
+    void Benchmarks::add(BenchmarkResult& result, std::size_t operations, std::size_t allocations) // add function start //
+    {
+        if(!wanted(result.name))
+            return;                                                                              // measured alongside a selected benchmark, but not asked for
+
+        double total = static_cast<double>(operations) * static_cast<double>(result.nanosecondsPerOperation.size());
+        result.allocationsPerOperation = total > 0.0 ? static_cast<double>(allocations) / total : 0.0;
+
+        std::cout << result.name << ": " << result.mean() << " ns/op (sd " << result.standardDeviation() << ")\n";
+        m_report.results.push_back(result);
+    }                                                                                            // add function end //
+
+    std::vector<long long> Benchmarks::shuffled(std::size_t count, std::uint64_t stream) const   // shuffled function start //
+    {
+        std::vector<long long> keys(count);
+        std::iota(keys.begin(), keys.end(), 0LL);
+
+        std::mt19937_64 generator{m_options.seed + stream};
+        std::shuffle(keys.begin(), keys.end(), generator);
+        return keys;
+    }                                                                                            // shuffled function end //
+
+    std::vector<long long> Benchmarks::randomKeys(std::size_t count) const                       // randomKeys function start //
+    {
+        std::mt19937_64 generator{m_options.seed};
+        std::vector<long long> keys(count);
+        for(long long& key : keys)
+            key = static_cast<long long>(generator());
+
+        std::vector<long long> sorted{keys};                                                     // repeats are astronomically unlikely, but a repeat would not be inserted
+        std::sort(sorted.begin(), sorted.end());
+        if(std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+            throw std::runtime_error{"Benchmarks randomKeys(), the generator repeated a key, try another seed"};
+        return keys;
+    }                                                                                            // randomKeys function end //
+
+    template <class Augmentation>
+    void Benchmarks::basic(const std::string& suffix)                                            // basic function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("insert" + suffix) && !selected("find" + suffix) && !selected("scan" + suffix) && !selected("remove" + suffix))
+            return;
+
+        typedef AVLTree<long long, Augmentation> Tree;
+
+        std::vector<long long> insertKeys = shuffled(n, 1);
+        std::vector<long long> findKeys = shuffled(n, 2);
+        std::vector<long long> removeKeys = shuffled(n, 3);
+
+        BenchmarkResult insert, find, scan, remove;
+        insert.name = named("insert" + suffix, n);
+        find.name = named("find" + suffix, n);
+        scan.name = named("scan" + suffix, n);
+        remove.name = named("remove" + suffix, n);
+
+        std::size_t insertAllocations = 0, findAllocations = 0, scanAllocations = 0, removeAllocations = 0;
+        PerfCounters::Reading insertCounts{}, findCounts{}, scanCounts{}, removeCounts{};      // summed over the runs, the timed region sits inside the counted one
+
+        for(std::size_t run = 0; run < m_options.runs; ++run)                                    // one run inserts, finds, scans and removes every key
+        {
+            std::unique_ptr<Tree> tree{new Tree{}};
+            std::size_t bytesBefore = s_liveBytes;
+
+            accumulate(insertCounts, m_counters.measure(n, [&]
+            {
+                insert.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    for(long long key : insertKeys)
+                        tree->insert(key);
+                }, insertAllocations));
+            }));
+
+            insert.bytesPerElement = static_cast<double>(s_liveBytes - bytesBefore) / static_cast<double>(n);
+            find.bytesPerElement = scan.bytesPerElement = remove.bytesPerElement = insert.bytesPerElement;
+
+            accumulate(findCounts, m_counters.measure(n, [&]
+            {
+                find.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    long long found = 0;
+                    for(long long key : findKeys)
+                        found += tree->find(key) != nullptr;
+                    s_sink = found;
+                }, findAllocations));
+            }));
+
+            accumulate(scanCounts, m_counters.measure(n, [&]
+            {
+                scan.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    long long sum = 0;
+                    for(typename Tree::ConstIterator it = tree->begin(); it != tree->end(); ++it)
+                        sum += *it;
+                    s_sink = sum;
+                }, scanAllocations));
+            }));
+
+            accumulate(removeCounts, m_counters.measure(n, [&]
+            {
+                remove.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    for(long long key : removeKeys)
+                        tree->remove(key);
+                }, removeAllocations));
+            }));
+        }
+
+        {                                                                                        // one more run times every operation on its own for the percentiles,
+            std::unique_ptr<Tree> tree{new Tree{}};                                              // the clock reads add some tens of ns to each latency
+            std::vector<double> latencies;
+            latencies.reserve(n);
+
+            auto latency = [&latencies](auto operation)
+            {
+                auto start = std::chrono::steady_clock::now();
+                operation();
+                auto stop = std::chrono::steady_clock::now();
+                latencies.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()));
+            };
+
+            for(long long key : insertKeys)
+                latency([&] { tree->insert(key); });
+            percentiles(insert, latencies);
+
+            latencies.clear();
+            for(long long key : findKeys)
+                latency([&] { s_sink = tree->find(key) != nullptr; });
+            percentiles(find, latencies);
+
+            latencies.clear();
+            typename Tree::ConstIterator it = tree->begin();
+            for(std::size_t i = 0; i < n; ++i)
+                latency([&] { s_sink = *it; ++it; });
+            percentiles(scan, latencies);
+
+            latencies.clear();
+            for(long long key : removeKeys)
+                latency([&] { tree->remove(key); });
+            percentiles(remove, latencies);
+        }
+
+        add(insert, n, insertAllocations);
+        add(find, n, findAllocations);
+        add(scan, n, scanAllocations);
+        add(remove, n, removeAllocations);
+
+        if(!m_counters.available())
+        {
+            std::cout << "hardware counters unavailable\n";
+            return;
+        }
+
+        const std::pair<const BenchmarkResult*, const PerfCounters::Reading*> phases[] = {
+            {&insert, &insertCounts}, {&find, &findCounts}, {&scan, &scanCounts}, {&remove, &removeCounts}};
+
+        for(const std::pair<const BenchmarkResult*, const PerfCounters::Reading*>& phase : phases)
+            if(wanted(phase.first->name))
+                PerfCounters::report(std::cout, phase.first->name.c_str(), *phase.second);
+    }                                                                                            // basic function end //
+
+    void Benchmarks::sortedBatch()                                                               // sortedBatch function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("find_each") && !selected("find_sorted_batch"))
+            return;
+
+        AVLTree<long long> tree;
+        std::vector<long long> keys = shuffled(n, 1);
+        for(long long key : keys)
+            tree.insert(key);
+
+        const std::size_t lookups = std::max<std::size_t>(100000, n / 10);                      // keys looked up per run, split into batches
+        std::mt19937_64 generator{m_options.seed + 4};
+        std::uniform_int_distribution<long long> key{0, static_cast<long long>(n) - 1};
+
+        for(std::size_t batchSize : {std::size_t{10}, std::size_t{1000}, std::size_t{100000}})
+        {
+            if(batchSize > lookups)
+                continue;
+
+            std::vector<std::vector<long long>> batches(lookups / batchSize, std::vector<long long>(batchSize));
+            for(std::vector<long long>& batch : batches)
+            {
+                for(long long& value : batch)
+                    value = key(generator);
+                std::sort(batch.begin(), batch.end());                                          // sorting is the caller's work, it is not timed
+            }
+
+            const std::size_t operations = batches.size() * batchSize;
+            BenchmarkResult each, batched;
+            each.name = named("find_each", batchSize);
+            batched.name = named("find_sorted_batch", batchSize);
+            std::size_t eachAllocations = 0, batchAllocations = 0;
+            std::vector<long long*> results;
+
+            for(std::size_t run = 0; run < m_options.runs; ++run)
+            {
+                each.nanosecondsPerOperation.push_back(timed(operations, [&]
+                {
+                    long long found = 0;
+                    for(const std::vector<long long>& batch : batches)
+                        for(long long value : batch)
+                            found += tree.find(value) != nullptr;
+                    s_sink = found;
+                }, eachAllocations));
+
+                batched.nanosecondsPerOperation.push_back(timed(operations, [&]
+                {
+                    long long found = 0;
+                    for(const std::vector<long long>& batch : batches)
+                    {
+                        tree.findSortedBatch(batch, results);
+                        found += results.back() != nullptr;
+                    }
+                    s_sink = found;
+                }, batchAllocations));
+            }
+
+            add(each, operations, eachAllocations);
+            add(batched, operations, batchAllocations);
+        }
+    }                                                                                            // sortedBatch function end //
+
+    void Benchmarks::hybrid()                                                                    // hybrid function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("hybrid_insert") && !selected("hybrid_find"))
+            return;
+
+        std::vector<long long> keys = randomKeys(n);
+        std::vector<long long> findKeys{keys};
+        std::mt19937_64 generator{m_options.seed + 5};
+        std::shuffle(findKeys.begin(), findKeys.end(), generator);
+
+        BenchmarkResult insert, find;
+        insert.name = named("hybrid_insert", n);
+        find.name = named("hybrid_find", n);
+        std::size_t insertAllocations = 0, findAllocations = 0;
+
+        for(std::size_t run = 0; run < m_options.runs; ++run)
+        {
+            std::unique_ptr<HybridAVLTree<long long>> container{new HybridAVLTree<long long>{}};
+            std::size_t bytesBefore = s_liveBytes;
+
+            insert.nanosecondsPerOperation.push_back(timed(n, [&]
+            {
+                for(long long key : keys)
+                    container->insert(key);
+            }, insertAllocations));
+
+            insert.bytesPerElement = find.bytesPerElement = static_cast<double>(s_liveBytes - bytesBefore) / static_cast<double>(n);
+
+            find.nanosecondsPerOperation.push_back(timed(n, [&]
+            {
+                long long found = 0;
+                for(long long key : findKeys)
+                    found += container->find(key) != nullptr;
+                s_sink = found;
+            }, findAllocations));
+        }
+
+        add(insert, n, insertAllocations);
+        add(find, n, findAllocations);
+    }                                                                                            // hybrid function end //
+
+    void Benchmarks::adaptive()                                                                  // adaptive function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("find_zipf") && !selected("adaptive_find_zipf"))
+            return;
+
+        std::vector<long long> keys = shuffled(n, 1);                                            // insertion order
+        std::vector<long long> byRank = shuffled(n, 6);                                          // byRank[r] is the key of popularity rank r
+
+        std::vector<double> cumulative(n);                                                       // zipf with exponent 1.1 over the ranks
+        double total = 0.0;
+        for(std::size_t rank = 0; rank < n; ++rank)
+            cumulative[rank] = total += 1.0 / std::pow(static_cast<double>(rank + 1), 1.1);
+
+        std::vector<long long> queries(n);
+        std::mt19937_64 generator{m_options.seed + 7};
+        std::uniform_real_distribution<double> uniform{0.0, total};
+        for(long long& query : queries)
+        {
+            std::size_t rank = static_cast<std::size_t>(std::lower_bound(cumulative.begin(), cumulative.end(), uniform(generator)) - cumulative.begin());
+            query = byRank[std::min(rank, n - 1)];
+        }
+
+        for(bool on : {false, true})
+        {
+            BenchmarkResult result;
+            result.name = named(on ? "adaptive_find_zipf" : "find_zipf", n);
+            std::size_t allocations = 0;
+            double depth = 0.0;
+
+            for(std::size_t run = 0; run < m_options.runs; ++run)
+            {
+                std::unique_ptr<AVLTree<long long, Adaptive>> tree{new AVLTree<long long, Adaptive>{}};
+                for(long long key : keys)
+                    tree->insert(key);
+                tree->setAdaptive(on);
+
+                result.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    long long found = 0;
+                    for(long long query : queries)
+                        found += tree->find(query) != nullptr;
+                    s_sink = found;
+                }, allocations));
+
+                depth = 0.0;                                                                     // depth the workload sees once the tree has adapted
+                for(std::size_t i = 0; i < n; i += 16)
+                    depth += static_cast<double>(tree->searchDepth(queries[i]));
+                depth /= static_cast<double>((n + 15) / 16);
+            }
+
+            std::cout << result.name << ": mean search depth " << depth << " nodes\n";
+            add(result, n, allocations);
+        }
+    }                                                                                            // adaptive function end //
+
+    void Benchmarks::treeDiff()                                                                  // treeDiff function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("diff_hashed") && !selected("diff_merge"))
+            return;
+
+        std::vector<int> values(n);
+        std::iota(values.begin(), values.end(), 0);
+
+        AVLTree<int, Hashed> base;
+        base.buildSorted(values);
+        base.setHashing(true);
+
+        for(std::size_t delta : {std::size_t{1}, std::size_t{100}, std::size_t{1000}, std::size_t{10000}})
+        {
+            if(delta > n)
+                continue;
+
+            AVLTree<int, Hashed> updated;                                                        // half the differences are removals, half are new values
+            updated.buildSorted(values);
+            updated.setHashing(true);
+
+            std::vector<long long> removed = shuffled(n, 8);
+            for(std::size_t i = 0; i < delta; ++i)
+            {
+                if(i % 2 == 0)
+                    updated.remove(static_cast<int>(removed[i]));
+                else
+                    updated.insert(static_cast<int>(n + i));
+            }
+
+            BenchmarkResult hashed, merged;
+            hashed.name = named("diff_hashed", delta);
+            merged.name = named("diff_merge", delta);
+            std::size_t hashedAllocations = 0, mergedAllocations = 0;
+
+            for(std::size_t run = 0; run < m_options.runs; ++run)                                // one operation is one whole diff
+            {
+                hashed.nanosecondsPerOperation.push_back(timed(1, [&]
+                {
+                    long long count = 0;
+                    diff(base, updated, [&count](int) { ++count; }, [&count](int) { ++count; });
+                    s_sink = count;
+                }, hashedAllocations));
+
+                merged.nanosecondsPerOperation.push_back(timed(1, [&]
+                {
+                    long long count = 0;
+                    TreeDiff<int, Hashed>::mergeDiff(base, updated, [&count](int) { ++count; }, [&count](int) { ++count; });
+                    s_sink = count;
+                }, mergedAllocations));
+            }
+
+            add(hashed, 1, hashedAllocations);
+            add(merged, 1, mergedAllocations);
+        }
+    }                                                                                            // treeDiff function end //
+
+    void Benchmarks::transactions()                                                              // transactions function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("transaction_insert") && !selected("locked_insert"))
+            return;
+
+        std::vector<long long> keys = shuffled(n, 1);
+
+        BenchmarkResult locked;
+        locked.name = named("locked_insert", n);
+        std::size_t lockedAllocations = 0;
+
+        for(std::size_t run = 0; run < m_options.runs; ++run)
+        {
+            std::unique_ptr<ConcurrentAVLTree<long long>> tree{new ConcurrentAVLTree<long long>{}};
+            locked.nanosecondsPerOperation.push_back(timed(n, [&]
+            {
+                for(long long key : keys)
+                    tree->insert(key);
+            }, lockedAllocations));
+        }
+
+        add(locked, n, lockedAllocations);
+
+        for(std::size_t batchSize : {std::size_t{16}, std::size_t{1024}, std::size_t{65536}})
+        {
+            if(batchSize > n)
+                continue;
+
+            BenchmarkResult batched;
+            batched.name = named("transaction_insert", batchSize);
+            std::size_t allocations = 0;
+
+            for(std::size_t run = 0; run < m_options.runs; ++run)
+            {
+                std::unique_ptr<ConcurrentAVLTree<long long>> tree{new ConcurrentAVLTree<long long>{}};
+                batched.nanosecondsPerOperation.push_back(timed(n, [&]
+                {
+                    Transaction<long long> transaction{*tree};
+                    for(std::size_t i = 0; i < n; ++i)
+                    {
+                        transaction.insert(keys[i]);
+                        if(transaction.pending() == batchSize || i + 1 == n)
+                            transaction.commit();
+                    }
+                }, allocations));
+            }
+
+            add(batched, n, allocations);
+        }
+    }                                                                                            // transactions function end //
+
+    void Benchmarks::append()                                                                    // append function start //
+    {
+        const std::size_t n = m_options.size;
+        if(!selected("append_insert"))
+            return;
+
+        BenchmarkResult result;
+        result.name = named("append_insert", n);
+        std::size_t allocations = 0;
+
+        for(std::size_t run = 0; run < m_options.runs; ++run)
+        {
+            std::unique_ptr<AVLTree<long long>> tree{new AVLTree<long long>{}};
+            result.nanosecondsPerOperation.push_back(timed(n, [&]
+            {
+                for(std::size_t i = 0; i < n; ++i)
+                    tree->insert(static_cast<long long>(i));
+            }, allocations));
+        }
+
+        add(result, n, allocations);
+    }                                                                                            // append function end //
+
+    void Benchmarks::estimates()                                                                 // estimates function start //
+    {
+        const std::size_t n = m_options.size;
+        const char* names[] = {"estimate_range", "exact_range", "scan_range", "sample"};
+        if(std::none_of(std::begin(names), std::end(names), [this](const char* name) { return selected(name); }))
+            return;
+
+        const std::size_t ranges = 20000;
+        const std::size_t scans = 200;                                                           // a scan of up to 100K values per range is slow, fewer ranges keep the run short
+        const std::size_t sampled = std::min<std::size_t>(10000, n);
+
+        std::mt19937_64 generator{m_options.seed + 9};
+        std::uniform_int_distribution<long long> length{10, 100000};
+        std::uniform_int_distribution<long long> start{0, static_cast<long long>(n) - 1};
+
+        std::vector<std::pair<long long, long long>> bounds(ranges);
+        for(std::pair<long long, long long>& range : bounds)
+        {
+            range.first = start(generator);
+            range.second = range.first + length(generator) - 1;
+        }
+
+        for(bool sequential : {true, false})
+        {
+            const std::string order = sequential ? "_sequential" : "_random";
+            std::vector<long long> keys = shuffled(n, 1);
+            if(sequential)
+                std::sort(keys.begin(), keys.end());
+
+            AVLTree<long long, Counted> tree;
+            for(long long key : keys)
+                tree.insert(key);
+
+            std::vector<double> errors;                                                          // relative errors of the shape estimate over ranges of at least 100 values
+
+            BenchmarkResult shape, exact, scan;
+            shape.name = named("estimate_range" + order, n);
+            exact.name = named("exact_range" + order, n);
+            scan.name = named("scan_range" + order, n);
+            std::size_t shapeAllocations = 0, exactAllocations = 0, scanAllocations = 0;
+
+            for(std::size_t run = 0; run < m_options.runs; ++run)
+            {
+                tree.setCounting(false);
+                shape.nanosecondsPerOperation.push_back(timed(ranges, [&]
+                {
+                    std::size_t sum = 0;
+                    for(const std::pair<long long, long long>& range : bounds)
+                        sum += tree.estimateRangeCount(range.first, range.second);
+                    s_sink = static_cast<long long>(sum);
+                }, shapeAllocations));
+
+                if(run == 0)
+                {
+                    for(const std::pair<long long, long long>& range : bounds)
+                    {
+                        double real = static_cast<double>(std::min(range.second, static_cast<long long>(n) - 1) - range.first + 1);
+                        if(real < 100.0)
+                            continue;
+                        errors.push_back(std::abs(static_cast<double>(tree.estimateRangeCount(range.first, range.second)) - real) / real);
+                    }
+                }
+
+                tree.setCounting(true);
+                exact.nanosecondsPerOperation.push_back(timed(ranges, [&]
+                {
+                    std::size_t sum = 0;
+                    for(const std::pair<long long, long long>& range : bounds)
+                        sum += tree.estimateRangeCount(range.first, range.second);
+                    s_sink = static_cast<long long>(sum);
+                }, exactAllocations));
+
+                scan.nanosecondsPerOperation.push_back(timed(scans, [&]
+                {
+                    std::size_t sum = 0;
+                    for(std::size_t i = 0; i < scans; ++i)
+                        for(auto it = tree.lowerBound(bounds[i].first); it != tree.end() && *it <= bounds[i].second; ++it)
+                            ++sum;
+                    s_sink = static_cast<long long>(sum);
+                }, scanAllocations));
+            }
+
+            if(!errors.empty())
+            {
+                std::sort(errors.begin(), errors.end());
+                std::cout << shape.name << ": relative error median " << errors[errors.size() / 2] << ", p90 " << errors[errors.size() * 9 / 10] << '\n';
+            }
+
+            add(shape, ranges, shapeAllocations);
+            add(exact, ranges, exactAllocations);
+            add(scan, scans, scanAllocations);
+
+            if(!sequential)
+                continue;
+
+            for(bool counted : {false, true})                                                    // one operation is one whole sample
+            {
+                BenchmarkResult sample;
+                sample.name = named(counted ? "sample_counted" : "sample", sampled);
+                std::size_t allocations = 0;
+                tree.setCounting(counted);
+
+                for(std::size_t run = 0; run < m_options.runs; ++run)
+                {
+                    sample.nanosecondsPerOperation.push_back(timed(1, [&]
+                    {
+                        s_sink = static_cast<long long>(tree.sample(sampled, generator).size());
+                    }, allocations));
+                }
+
+                add(sample, 1, allocations);
+            }
+        }
+    }                                                                                            // estimates function end //
+
+    void usage()                                                                                 // usage function start //
+    {
+        std::cerr << "usage: AVLTreeBenchmark [--size n] [--runs r] [--seed s] [--filter text] [--output report.json]\n";
+    }                                                                                            // usage function end //
+}
+
+void* operator new(std::size_t bytes)                                                            // counts every allocation of the benchmarks
+{                                                                                                // operator new function start //
+    ++s_allocations;
+    s_liveBytes += bytes;
+
+    char* memory = static_cast<char*>(std::malloc(s_header + bytes));
+    if(memory == nullptr)
+        throw std::bad_alloc{};
+
+    *reinterpret_cast<std::size_t*>(memory) = bytes;
+    return memory + s_header;
+}                                                                                                // operator new function end //
+
+#if defined(__GNUC__) && !defined(__clang__)                                                     // once inlined, gcc checks the header arithmetic and the free() against the new expression,
+#pragma GCC diagnostic push                                                                      // not against the malloc() of the replaced operator new
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#if __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+#endif
+
+void operator delete(void* memory) noexcept                                                      // operator delete function start //
+{
+    if(memory == nullptr)
+        return;
+
+    char* start = static_cast<char*>(memory) - s_header;
+    s_liveBytes -= *reinterpret_cast<std::size_t*>(start);
+    std::free(start);
+}                                                                                                // operator delete function end //
+
+void operator delete(void* memory, std::size_t) noexcept                                         // sized operator delete function start //
+{
+    operator delete(memory);
+}                                                                                                // sized operator delete function end //
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+int main(int argc, char** argv)                                                                  // main function start //
+{
+    Options options;
+
+    try
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string argument = argv[i];
+            if(i + 1 >= argc)
+            {
+                usage();
+                return 2;
+            }
+
+            std::string value = argv[++i];
+            if(argument == "--size")
+                options.size = std::stoull(value);
+            else if(argument == "--runs")
+                options.runs = std::stoull(value);
+            else if(argument == "--seed")
+                options.seed = std::stoull(value);
+            else if(argument == "--filter")
+                options.filter = value;
+            else if(argument == "--output")
+                options.output = value;
+            else
+            {
+                usage();
+                return 2;
+            }
+        }
+
+        if(options.size == 0 || options.runs == 0)
+        {
+            usage();
+            return 2;
+        }
+
+        Benchmarks benchmarks{options};
+        benchmarks.run();
+
+        std::ofstream out{options.output};
+        benchmarks.report().writeJson(out);
+        if(!out)
+            throw std::runtime_error{"AVLTreeBenchmark main(), could not write " + options.output};
+
+        std::cout << "wrote " << benchmarks.report().results.size() << " results to " << options.output << '\n';
+    }
+    catch(const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}                                                                                                // main function end //
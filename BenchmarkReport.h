@@ -0,0 +1,503 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace DataStructures
+{
+    // machine readable benchmark results and a comparison of two result sets
+    // every benchmark keeps the ns/op of each repeated run, so a comparison can tell noise from a real change
+    struct BenchmarkResult
+    {
+        std::string name;                            // e.g. "insert", "find" or "remove" plus the tree size
+        std::vector<double> nanosecondsPerOperation; // one sample per repeated run
+        double allocationsPerOperation = 0.0;        // heap allocations per operation, filled in by the benchmark
+        double bytesPerElement = 0.0;                // memory used by the container divided by its size
+        double p50 = 0.0;                            // latency percentiles of single operations in nanoseconds
+        double p90 = 0.0;
+        double p99 = 0.0;
+
+        double mean() const;                         // mean of the ns/op samples
+        double standardDeviation() const;            // sample standard deviation of the ns/op samples, 0 with less than two samples
+    };
+
+    struct HardwareInfo
+    {
+        std::string cpu;                             // cpu model name, "unknown" if it cannot be found
+        unsigned threads = 0;                        // hardware threads
+        std::string compiler;                        // compiler and version the benchmark was built with
+
+        static HardwareInfo current();               // describes the machine and build running now
+    };
+
+    struct BenchmarkReport
+    {
+        HardwareInfo hardware;
+        std::vector<BenchmarkResult> results;
+
+        void writeJson(std::ostream&) const;             // writes the report as a json object, numbers round trip exactly and non finite ones are written as null
+        static BenchmarkReport readJson(std::istream&);  // reads a report written by writeJson(), null numbers read as NaN, throws on malformed input
+    };
+
+    struct BenchmarkComparison
+    {
+        std::string name;                            // benchmark present in both reports
+        double baseMean;                             // mean ns/op of the base report
+        double candidateMean;                        // mean ns/op of the candidate report
+        double change;                               // relative change of the mean, 0.1 means 10% slower
+        double changeLow;                            // 95% confidence interval of the relative change
+        double changeHigh;
+        bool significant;                            // true if the interval does not contain 0
+
+        bool regression(double threshold) const { return significant && changeLow > threshold; } // true if the candidate is certainly more than threshold slower
+    };
+
+    std::vector<BenchmarkComparison> compareReports(const BenchmarkReport& base, const BenchmarkReport& candidate); // pairs benchmarks by name and runs a Welch t test on each
+    void printComparison(std::ostream&, const std::vector<BenchmarkComparison>&, double threshold = 0.05);        // one line per benchmark, regressions above threshold are marked
+
+    namespace BenchmarkJson
+    {
+        struct Value                                 // parsed json value, only what benchmark reports use
+        {
+            enum Type { Null, Number, String, Array, Object } type = Null;
+            double number = 0.0;
+            std::string string;
+            std::vector<Value> array;
+            std::vector<std::pair<std::string, Value>> object;
+
+            const Value* member(const std::string& key) const; // returns the member with the given key, nullptr if missing
+        };
+
+        class Parser
+        {
+            std::istream& m_in;
+
+            public:
+
+            explicit Parser(std::istream& in) : m_in{in} {}
+
+            Value parse();                           // parses the next value
+
+            private:
+
+            void skipSpace();
+            void expect(char);
+            std::string parseString();
+            double parseNumber();
+        };
+
+        void writeString(std::ostream&, const std::string&);  // writes a quoted, escaped string
+        void writeNumber(std::ostream&, double);              // writes the number with enough digits to read back the same double, null if it is not finite
+        double tCritical(double degreesOfFreedom);             // two sided 95% critical value of Student's t distribution
+    }
+
+    inline double BenchmarkResult::mean() const                    // mean function start //
+    {
+        if(nanosecondsPerOperation.empty())
+            return 0.0;
+
+        double sum = 0.0;
+        for(double sample : nanosecondsPerOperation)
+            sum += sample;
+        return sum / static_cast<double>(nanosecondsPerOperation.size());
+    }                                                              // mean function end //
+
+    inline double BenchmarkResult::standardDeviation() const       // standardDeviation function start //
+    {
+        std::size_t count = nanosecondsPerOperation.size();
+        if(count < 2)
+            return 0.0;
+
+        double average = mean();
+        double squares = 0.0;
+        for(double sample : nanosecondsPerOperation)
+            squares += (sample - average) * (sample - average);
+        return std::sqrt(squares / static_cast<double>(count - 1));
+    }                                                              // standardDeviation function end //
+
+    inline HardwareInfo HardwareInfo::current()                    // current function start //
+    {
+        HardwareInfo info;
+        info.cpu = "unknown";
+        info.threads = std::thread::hardware_concurrency();
+
+        std::ifstream cpuinfo{"/proc/cpuinfo"};                    // linux only, other systems keep "unknown"
+        std::string line;
+        while(std::getline(cpuinfo, line))
+        {
+            if(line.compare(0, 10, "model name") != 0)
+                continue;
+
+            std::size_t colon = line.find(':');
+            if(colon != std::string::npos && colon + 2 <= line.size())
+                info.cpu = line.substr(colon + 2);
+            break;
+        }
+
+#if defined(__clang__)
+        info.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        info.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        info.compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+        info.compiler = "unknown";
+#endif
+        return info;
+    }                                                              // current function end //
+
+    inline void BenchmarkReport::writeJson(std::ostream& out) const          // writeJson function start //
+    {
+        out << "{\n  \"hardware\": {\"cpu\": ";
+        BenchmarkJson::writeString(out, hardware.cpu);
+        out << ", \"threads\": " << hardware.threads << ", \"compiler\": ";
+        BenchmarkJson::writeString(out, hardware.compiler);
+        out << "},\n  \"results\": [";
+
+        for(std::size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchmarkResult& result = results[i];
+
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+            BenchmarkJson::writeString(out, result.name);
+            out << ", \"ns_per_op\": [";
+
+            for(std::size_t j = 0; j < result.nanosecondsPerOperation.size(); ++j)
+            {
+                out << (j == 0 ? "" : ", ");
+                BenchmarkJson::writeNumber(out, result.nanosecondsPerOperation[j]);
+            }
+
+            out << "], \"allocations_per_op\": ";
+            BenchmarkJson::writeNumber(out, result.allocationsPerOperation);
+            out << ", \"bytes_per_element\": ";
+            BenchmarkJson::writeNumber(out, result.bytesPerElement);
+            out << ", \"p50_ns\": ";
+            BenchmarkJson::writeNumber(out, result.p50);
+            out << ", \"p90_ns\": ";
+            BenchmarkJson::writeNumber(out, result.p90);
+            out << ", \"p99_ns\": ";
+            BenchmarkJson::writeNumber(out, result.p99);
+            out << '}';
+        }
+
+        out << "\n  ]\n}\n";
+    }                                                                        // writeJson function end //
+
+    inline BenchmarkReport BenchmarkReport::readJson(std::istream& in)       // readJson function start //
+    {
+        BenchmarkJson::Value root = BenchmarkJson::Parser{in}.parse();
+        if(root.type != BenchmarkJson::Value::Object)
+            throw std::runtime_error{
+                "BenchmarkReport readJson(), report is not a json object"};
+
+        auto value = [](const BenchmarkJson::Value& number)                     // null is what writeJson() writes for a non finite number
+        {
+            return number.type == BenchmarkJson::Value::Null ? std::numeric_limits<double>::quiet_NaN() : number.number;
+        };
+
+        auto number = [&value](const BenchmarkJson::Value& object, const char* key)   // missing numbers read as 0
+        {
+            const BenchmarkJson::Value* member = object.member(key);
+            return member != nullptr ? value(*member) : 0.0;
+        };
+
+        auto string = [](const BenchmarkJson::Value& object, const char* key)
+        {
+            const BenchmarkJson::Value* member = object.member(key);
+            return member != nullptr && member->type == BenchmarkJson::Value::String ? member->string : std::string{};
+        };
+
+        BenchmarkReport report;
+
+        if(const BenchmarkJson::Value* hardware = root.member("hardware"))
+        {
+            report.hardware.cpu = string(*hardware, "cpu");
+            report.hardware.threads = static_cast<unsigned>(number(*hardware, "threads"));
+            report.hardware.compiler = string(*hardware, "compiler");
+        }
+
+        const BenchmarkJson::Value* results = root.member("results");
+        if(results == nullptr || results->type != BenchmarkJson::Value::Array)
+            throw std::runtime_error{
+                "BenchmarkReport readJson(), report has no results array"};
+
+        for(const BenchmarkJson::Value& entry : results->array)
+        {
+            BenchmarkResult result;
+            result.name = string(entry, "name");
+
+            if(const BenchmarkJson::Value* samples = entry.member("ns_per_op"))
+                for(const BenchmarkJson::Value& sample : samples->array)
+                    result.nanosecondsPerOperation.push_back(value(sample));
+
+            result.allocationsPerOperation = number(entry, "allocations_per_op");
+            result.bytesPerElement = number(entry, "bytes_per_element");
+            result.p50 = number(entry, "p50_ns");
+            result.p90 = number(entry, "p90_ns");
+            result.p99 = number(entry, "p99_ns");
+            report.results.push_back(result);
+        }
+
+        return report;
+    }                                                                        // readJson function end //
+
+    inline std::vector<BenchmarkComparison> compareReports(const BenchmarkReport& base, const BenchmarkReport& candidate)
+    {                                                                        // compareReports function start //
+        std::vector<BenchmarkComparison> comparisons;
+
+        for(const BenchmarkResult& before : base.results)
+        {
+            for(const BenchmarkResult& after : candidate.results)
+            {
+                if(after.name != before.name)
+                    continue;
+
+                BenchmarkComparison comparison;
+                comparison.name = before.name;
+                comparison.baseMean = before.mean();
+                comparison.candidateMean = after.mean();
+
+                double baseVariance = before.standardDeviation() * before.standardDeviation() / static_cast<double>(before.nanosecondsPerOperation.size());
+                double candidateVariance = after.standardDeviation() * after.standardDeviation() / static_cast<double>(after.nanosecondsPerOperation.size());
+                double standardError = std::sqrt(baseVariance + candidateVariance);
+
+                double interval = 0.0;                                       // half width of the interval of the difference of means
+                if(standardError > 0.0 && before.nanosecondsPerOperation.size() > 1 && after.nanosecondsPerOperation.size() > 1)
+                {
+                    double degreesOfFreedom = (baseVariance + candidateVariance) * (baseVariance + candidateVariance)   // Welch Satterthwaite
+                        / (baseVariance * baseVariance / static_cast<double>(before.nanosecondsPerOperation.size() - 1)
+                         + candidateVariance * candidateVariance / static_cast<double>(after.nanosecondsPerOperation.size() - 1));
+                    interval = BenchmarkJson::tCritical(degreesOfFreedom) * standardError;
+                }
+
+                double difference = comparison.candidateMean - comparison.baseMean;
+                double scale = comparison.baseMean != 0.0 ? comparison.baseMean : 1.0;
+
+                comparison.change = difference / scale;
+                comparison.changeLow = (difference - interval) / scale;
+                comparison.changeHigh = (difference + interval) / scale;
+                comparison.significant = interval > 0.0 && (comparison.changeLow > 0.0 || comparison.changeHigh < 0.0);
+
+                comparisons.push_back(comparison);
+                break;
+            }
+        }
+
+        return comparisons;
+    }                                                                        // compareReports function end //
+
+    inline void printComparison(std::ostream& out, const std::vector<BenchmarkComparison>& comparisons, double threshold)
+    {                                                                        // printComparison function start //
+        char line[256];
+
+        for(const BenchmarkComparison& comparison : comparisons)
+        {
+            std::snprintf(line, sizeof(line), "%-32s %10.2f -> %10.2f ns/op  %+7.2f%% [%+7.2f%%, %+7.2f%%]%s\n",
+                comparison.name.c_str(), comparison.baseMean, comparison.candidateMean,
+                100.0 * comparison.change, 100.0 * comparison.changeLow, 100.0 * comparison.changeHigh,
+                comparison.regression(threshold) ? "  REGRESSION" : (comparison.significant ? "  significant" : ""));
+            out << line;
+        }
+    }                                                                        // printComparison function end //
+
+    inline const BenchmarkJson::Value* BenchmarkJson::Value::member(const std::string& key) const
+    {                                                                        // member function start //
+        for(const std::pair<std::string, Value>& entry : object)
+            if(entry.first == key)
+                return &entry.second;
+        return nullptr;
+    }                                                                        // member function end //
+
+    inline BenchmarkJson::Value BenchmarkJson::Parser::parse()              // parse function start //
+    {
+        Value value;
+        skipSpace();
+        int next = m_in.peek();
+
+        if(next == '{')
+        {
+            value.type = Value::Object;
+            m_in.get();
+            skipSpace();
+
+            if(m_in.peek() == '}')
+            {
+                m_in.get();
+                return value;
+            }
+
+            while(true)
+            {
+                skipSpace();
+                std::string key = parseString();
+                skipSpace();
+                expect(':');
+                value.object.emplace_back(key, parse());
+                skipSpace();
+
+                if(m_in.peek() == ',')
+                    m_in.get();
+                else
+                {
+                    expect('}');
+                    return value;
+                }
+            }
+        }
+
+        else if(next == '[')
+        {
+            value.type = Value::Array;
+            m_in.get();
+            skipSpace();
+
+            if(m_in.peek() == ']')
+            {
+                m_in.get();
+                return value;
+            }
+
+            while(true)
+            {
+                value.array.push_back(parse());
+                skipSpace();
+
+                if(m_in.peek() == ',')
+                    m_in.get();
+                else
+                {
+                    expect(']');
+                    return value;
+                }
+            }
+        }
+
+        else if(next == '"')
+        {
+            value.type = Value::String;
+            value.string = parseString();
+        }
+
+        else if(next == 'n')                                                 // null
+        {
+            expect('n'); expect('u'); expect('l'); expect('l');
+        }
+
+        else
+        {
+            value.type = Value::Number;
+            value.number = parseNumber();
+        }
+
+        return value;
+    }                                                                        // parse function end //
+
+    inline void BenchmarkJson::Parser::skipSpace()                          // skipSpace function start //
+    {
+        while(m_in.peek() == ' ' || m_in.peek() == '\n' || m_in.peek() == '\t' || m_in.peek() == '\r')
+            m_in.get();
+    }                                                                        // skipSpace function end //
+
+    inline void BenchmarkJson::Parser::expect(char expected)                // expect function start //
+    {
+        if(m_in.get() != expected)
+            throw std::runtime_error{
+                std::string{"BenchmarkReport readJson(), expected '"} + expected + "'"};
+    }                                                                        // expect function end //
+
+    inline std::string BenchmarkJson::Parser::parseString()                 // parseString function start //
+    {
+        expect('"');
+        std::string result;
+
+        while(true)
+        {
+            int next = m_in.get();
+
+            if(next == std::char_traits<char>::eof())
+                throw std::runtime_error{
+                    "BenchmarkReport readJson(), unterminated string"};
+
+            if(next == '"')
+                return result;
+
+            if(next == '\\')                                                 // only the escapes writeString() produces
+            {
+                next = m_in.get();
+                if(next == 'n')
+                    next = '\n';
+                else if(next == 't')
+                    next = '\t';
+            }
+
+            result.push_back(static_cast<char>(next));
+        }
+    }                                                                        // parseString function end //
+
+    inline double BenchmarkJson::Parser::parseNumber()                      // parseNumber function start //
+    {
+        double number;
+        if(!(m_in >> number))
+            throw std::runtime_error{
+                "BenchmarkReport readJson(), expected a number"};
+        return number;
+    }                                                                        // parseNumber function end //
+
+    inline void BenchmarkJson::writeString(std::ostream& out, const std::string& text)
+    {                                                                        // writeString function start //
+        out << '"';
+        for(char character : text)
+        {
+            if(character == '"' || character == '\\')
+                out << '\\' << character;
+            else if(character == '\n')
+                out << "\\n";
+            else if(character == '\t')
+                out << "\\t";
+            else
+                out << character;
+        }
+        out << '"';
+    }                                                                        // writeString function end //
+
+    inline void BenchmarkJson::writeNumber(std::ostream& out, double number)
+    {                                                                        // writeNumber function start //
+        if(!std::isfinite(number))                                           // json has no inf or nan, a reader would choke on them
+        {
+            out << "null";
+            return;
+        }
+
+        std::streamsize precision = out.precision();
+        out << std::setprecision(std::numeric_limits<double>::max_digits10) << number << std::setprecision(precision);
+    }                                                                        // writeNumber function end //
+
+    inline double BenchmarkJson::tCritical(double degreesOfFreedom)         // tCritical function start //
+    {
+        static const double table[30] = {                                    // two sided 95% values for 1 - 30 degrees of freedom
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+        if(degreesOfFreedom < 1.0)
+            return table[0];
+
+        if(degreesOfFreedom >= 30.0)                                         // close enough to the normal distribution from here
+            return degreesOfFreedom >= 120.0 ? 1.960 : 2.042 - (degreesOfFreedom - 30.0) * (2.042 - 1.980) / 90.0;
+
+        std::size_t lower = static_cast<std::size_t>(degreesOfFreedom);      // interpolate between whole degrees of freedom
+        double fraction = degreesOfFreedom - static_cast<double>(lower);
+        return table[lower - 1] + fraction * (table[lower] - table[lower - 1]);
+    }                                                                        // tCritical function end //
+}
@@ -0,0 +1,377 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    struct CheckpointManifest                        // names the newest checkpoint, replaced by a rename once a generation is completely written
+    {
+        std::uint64_t magic;                         // s_checkpointMagic
+        std::uint32_t valueSize;                     // sizeof(T) of the writer
+        std::uint32_t reserved;                      // zero
+        std::uint64_t base;                          // oldest generation the newest one refers to, 0 if nothing was checkpointed
+        std::uint64_t latest;                        // newest generation
+        std::uint64_t root;                          // reference to the root record, 0 for an empty tree
+        std::uint64_t size;                          // number of values in the checkpointed tree
+    };
+
+    struct CheckpointGenerationHeader                // start of every generation file, followed by its records
+    {
+        std::uint64_t magic;                         // s_checkpointMagic
+        std::uint32_t valueSize;                     // sizeof(T) of the writer
+        std::uint32_t reserved;                      // zero
+        std::uint64_t generation;                    // number of this generation
+        std::uint64_t records;                       // number of records following the header
+    };
+
+    static const std::uint64_t s_checkpointMagic = 0x54504b434c5641; // "AVLCKPT"
+
+    struct CheckpointAugmentation : NoAugmentation   // the least a checkpointed tree has to keep, trees can derive from it to keep more
+    {
+        static const bool checkpoints = true;
+    };
+
+    // incremental checkpoints of an AVLTree
+    // every checkpoint is a new generation file holding only the subtrees changed since the previous one, each node a record of its value
+    // and references to its children's records, an unchanged child is referenced in the older generation that already holds it
+    // nodes remember their record in checkpointRef, which AVLTree::update() clears whenever a node or anything below it changes,
+    // so a checkpoint visits only the changed paths and costs O(changes * log n) instead of O(n)
+    // compact() writes the whole tree as one generation and deletes the older ones, bounding the chain a restore has to read
+    // files are flushed but not synced, a crash can lose the newest checkpoint to the operating system but never mixes two of them
+    // a tree must only be checkpointed through one store, references of another store's generations would be taken as its own
+    // the tree's augmentation has to keep checkpoint records, AVLTree<T, CheckpointAugmentation> is the smallest that does
+    template <class T, class Augmentation = CheckpointAugmentation>
+    class CheckpointStore
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "CheckpointStore writes raw bytes of T");
+        static_assert(Augmentation::checkpoints, "CheckpointStore needs an augmentation that keeps checkpoint records");
+
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::Node Node;
+
+        struct Record
+        {
+            T value;
+            std::uint64_t left;                      // reference to the left child's record, 0 if there is none
+            std::uint64_t right;                     // reference to the right child's record, 0 if there is none
+        };
+
+        struct Writer                                // state of the generation being written
+        {
+            std::ofstream out;
+            std::vector<Record> buffer;              // records not written yet
+            std::uint64_t generation;
+            std::uint64_t records;                   // records appended so far
+        };
+
+        std::string m_prefix;                        // files are m_prefix + ".manifest" and m_prefix + ".<generation>"
+        std::uint64_t m_base;                        // oldest generation still referenced, 0 if there is none
+        std::uint64_t m_latest;                      // newest generation, 0 if there is none
+        std::uint64_t m_treeId;                      // tree whose node references point into these generations, 0 if none does
+
+        public:
+
+        explicit CheckpointStore(const std::string& prefix);  // opens the checkpoints under prefix, reading its manifest if there is one
+        CheckpointStore(const CheckpointStore&) = delete;     // copy constructor disabled
+
+        std::uint64_t checkpoint(Tree&);             // writes the subtrees changed since the last checkpoint as a new generation, returns the records written
+                                                     // a tree this store did not write or restore last is written whole, like compact()
+        std::uint64_t compact(Tree&);                // writes the whole tree as a new generation and deletes the older ones, returns the records written
+        void restore(Tree&);                         // replaces the tree's contents with the newest checkpoint, throws if the files are damaged
+
+        std::uint64_t generations() const { return m_latest == 0 ? 0 : m_latest - m_base + 1; } // returns the number of generation files a restore reads
+        std::uint64_t latest() const { return m_latest; }                                      // returns the newest generation, 0 if there is none
+
+        static std::size_t recordSize() { return sizeof(Record); }   // returns the bytes written per changed node
+
+        private:
+
+        std::uint64_t write(Tree&, bool whole);                      // writes a new generation and publishes it in the manifest
+
+        std::uint64_t writeNodes(Node*, Writer&, bool whole);        // appends the records of the subtree's changed nodes children first, returns the subtree's reference
+        void flush(Writer&);                                         // writes the buffered records
+
+        Node* readNodes(std::uint64_t reference, Node* parent, const std::vector<std::vector<Record>>& generations,
+                        Tree&, std::size_t& count, Node*& previous); // builds the subtree of the referenced record in order after previous, references must have been checked
+
+        CheckpointManifest readManifest();                           // loads the manifest's generations, returns it zeroed if there is none yet
+        void writeManifest(const CheckpointManifest&);               // replaces the manifest through a temporary file and a rename
+
+        std::string generationPath(std::uint64_t generation) const { return m_prefix + "." + std::to_string(generation); }
+
+        static std::uint64_t reference(std::uint64_t generation, std::uint64_t index) { return (generation << s_indexBits) | index; }
+        static std::uint64_t generationOf(std::uint64_t reference) { return reference >> s_indexBits; }
+        static std::uint64_t indexOf(std::uint64_t reference) { return reference & ((std::uint64_t{1} << s_indexBits) - 1); }
+
+        static const int s_indexBits = 40;           // low bits of a reference index the record, the high bits hold its generation, which starts at 1 so no reference is 0
+        static const std::size_t s_bufferRecords = 1 << 16;
+    };
+
+    template <typename T, typename Augmentation>
+    CheckpointStore<T, Augmentation>::CheckpointStore(const std::string& prefix) :
+        m_prefix{prefix}, m_base{0}, m_latest{0}, m_treeId{0}
+    {                                                                                       // constructor start //
+        readManifest();
+    }                                                                                       // constructor end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t CheckpointStore<T, Augmentation>::checkpoint(Tree& tree)                  // checkpoint function start //
+    {
+        return write(tree, tree.m_id != m_treeId || m_latest == 0);
+    }                                                                                       // checkpoint function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t CheckpointStore<T, Augmentation>::compact(Tree& tree)                     // compact function start //
+    {
+        return write(tree, true);
+    }                                                                                       // compact function end //
+
+    template <typename T, typename Augmentation>
+    void CheckpointStore<T, Augmentation>::restore(Tree& tree)                              // restore function start //
+    {
+        CheckpointManifest manifest = readManifest();                                       // another store may have checkpointed since this one was opened
+        std::uint64_t root = manifest.root;
+        std::vector<std::vector<Record>> generations;                                       // records of every generation from m_base on
+
+        if(m_latest != 0)
+        {
+            for(std::uint64_t generation = m_base; generation <= m_latest; ++generation)
+            {
+                std::string path = generationPath(generation);
+                std::ifstream in{path, std::ios::binary};
+                CheckpointGenerationHeader header{};
+                in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+                if(!in || header.magic != s_checkpointMagic || header.valueSize != sizeof(T) || header.generation != generation)
+                    throw std::runtime_error{
+                        "CheckpointStore restore(), " + path + " is not a checkpoint generation of this store"};
+
+                generations.emplace_back(static_cast<std::size_t>(header.records));
+                in.read(reinterpret_cast<char*>(generations.back().data()), static_cast<std::streamsize>(header.records * sizeof(Record)));
+
+                if(!in)
+                    throw std::runtime_error{
+                        "CheckpointStore restore(), " + path + " is truncated"};
+            }
+        }
+
+        auto valid = [this, &generations](std::uint64_t child, std::uint64_t parent)      // children are written before their parents, so their references are smaller,
+        {                                                                                   // which also rules out cycles
+            std::uint64_t generation = generationOf(child);
+            return child < parent && generation >= m_base && generation <= m_latest &&
+                   indexOf(child) < generations[generation - m_base].size();
+        };
+
+        if(root != 0 && !valid(root, reference(m_latest + 1, 0)))
+            throw std::runtime_error{
+                "CheckpointStore restore(), manifest holds an invalid root reference"};
+
+        for(std::size_t i = 0; i < generations.size(); ++i)                                 // checked up front, so building the nodes cannot fail half way
+            for(std::size_t j = 0; j < generations[i].size(); ++j)
+            {
+                const Record& record = generations[i][j];
+                std::uint64_t self = reference(m_base + i, j);
+
+                if((record.left != 0 && !valid(record.left, self)) || (record.right != 0 && !valid(record.right, self)))
+                    throw std::runtime_error{
+                        "CheckpointStore restore(), " + generationPath(m_base + i) + " holds an invalid reference"};
+            }
+
+        tree.clear();
+
+        std::size_t count = 0;
+        Node* previous = nullptr;
+        tree.m_root = root == 0 ? nullptr : readNodes(root, nullptr, generations, tree, count, previous);
+        tree.m_size = count;
+
+        if(count != manifest.size)                                                          // a record referenced twice passes the checks above but not this one
+        {
+            tree.clear();
+            throw std::runtime_error{
+                "CheckpointStore restore(), checkpoint holds a different number of values than its manifest"};
+        }
+
+        m_treeId = tree.m_id;
+    }                                                                                       // restore function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t CheckpointStore<T, Augmentation>::write(Tree& tree, bool whole)           // write function start //
+    {
+        readManifest();                                                                     // forgets the tree's references if another store moved the generations on
+        whole = whole || tree.m_id != m_treeId;
+
+        if(m_latest + 1 >= (std::uint64_t{1} << (64 - s_indexBits)))
+            throw std::runtime_error{
+                "CheckpointStore write(), generation numbers are exhausted"};
+
+        Writer writer{std::ofstream{}, std::vector<Record>{}, m_latest + 1, 0};
+        std::string path = generationPath(writer.generation);
+        writer.out.open(path, std::ios::binary | std::ios::trunc);
+
+        if(!writer.out)
+            throw std::runtime_error{
+                "CheckpointStore write(), cannot open " + path};
+
+        writer.buffer.reserve(s_bufferRecords);
+        CheckpointManifest manifest{s_checkpointMagic, static_cast<std::uint32_t>(sizeof(T)), 0,
+                                    whole ? writer.generation : m_base, writer.generation, 0, tree.size()};
+
+        try
+        {
+            CheckpointGenerationHeader header{s_checkpointMagic, static_cast<std::uint32_t>(sizeof(T)), 0, writer.generation, 0}; // records are filled in at the end
+            writer.out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            manifest.root = writeNodes(tree.m_root, writer, whole);
+            flush(writer);
+
+            header.records = writer.records;
+            writer.out.seekp(0);
+            writer.out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writer.out.close();
+
+            if(!writer.out)
+                throw std::runtime_error{
+                    "CheckpointStore write(), cannot write " + path};
+
+            writeManifest(manifest);                                                        // the new generation counts from here on
+        }
+        catch(...)
+        {
+            m_treeId = 0;                                                                   // nodes already refer to the unpublished generation, the next checkpoint writes everything
+            throw;
+        }
+
+        std::uint64_t oldBase = m_base;
+        std::uint64_t oldLatest = m_latest;
+
+        m_base = manifest.base;
+        m_latest = manifest.latest;
+        m_treeId = tree.m_id;
+
+        if(whole)                                                                           // nothing refers to the older generations anymore
+            for(std::uint64_t generation = oldBase; generation != 0 && generation <= oldLatest; ++generation)
+                std::remove(generationPath(generation).c_str());
+
+        return writer.records;
+    }                                                                                       // write function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t CheckpointStore<T, Augmentation>::writeNodes(Node* node, Writer& writer, bool whole)
+    {                                                                                       // writeNodes function start //
+        if(node == nullptr)
+            return 0;
+
+        if(!whole && node->checkpointRef != 0)                                              // unchanged since the last checkpoint, refer to its record
+            return node->checkpointRef;
+
+        Record record{node->value, writeNodes(node->left, writer, whole), writeNodes(node->right, writer, whole)};
+
+        if(writer.records == (std::uint64_t{1} << s_indexBits))
+            throw std::runtime_error{
+                "CheckpointStore writeNodes(), too many records for one generation"};
+
+        if(writer.buffer.size() == writer.buffer.capacity())
+            flush(writer);
+
+        writer.buffer.push_back(record);
+        node->checkpointRef = reference(writer.generation, writer.records++);
+        return node->checkpointRef;
+    }                                                                                       // writeNodes function end //
+
+    template <typename T, typename Augmentation>
+    void CheckpointStore<T, Augmentation>::flush(Writer& writer)                            // flush function start //
+    {
+        writer.out.write(reinterpret_cast<const char*>(writer.buffer.data()), static_cast<std::streamsize>(writer.buffer.size() * sizeof(Record)));
+        writer.buffer.clear();
+
+        if(!writer.out)
+            throw std::runtime_error{
+                "CheckpointStore flush(), cannot write generation " + std::to_string(writer.generation)};
+    }                                                                                       // flush function end //
+
+    template <typename T, typename Augmentation>
+    typename CheckpointStore<T, Augmentation>::Node* CheckpointStore<T, Augmentation>::readNodes(std::uint64_t reference, Node* parent,
+        const std::vector<std::vector<Record>>& generations, Tree& tree, std::size_t& count, Node*& previous)
+    {                                                                                       // readNodes function start //
+        if(reference == 0)
+            return nullptr;
+
+        const Record& record = generations[generationOf(reference) - m_base][indexOf(reference)];
+        Node* node = new Node{record.value, parent};
+        ++count;
+
+        node->left = readNodes(record.left, node, generations, tree, count, previous);
+
+        if constexpr(Augmentation::threaded)
+            if(previous != nullptr)
+                previous->next = node;
+        previous = node;
+
+        node->right = readNodes(record.right, node, generations, tree, count, previous);
+        tree.update(node);
+        node->checkpointRef = reference;                                                    // the node matches its record, the next checkpoint can refer to it
+
+        return node;
+    }                                                                                       // readNodes function end //
+
+    template <typename T, typename Augmentation>
+    CheckpointManifest CheckpointStore<T, Augmentation>::readManifest()                     // readManifest function start //
+    {
+        std::string path = m_prefix + ".manifest";
+        std::ifstream in{path, std::ios::binary};
+        CheckpointManifest manifest{};
+
+        if(!in)                                                                             // nothing was checkpointed yet
+        {
+            m_base = 0;
+            m_latest = 0;
+            return manifest;
+        }
+
+        in.read(reinterpret_cast<char*>(&manifest), sizeof(manifest));
+
+        if(!in || manifest.magic != s_checkpointMagic || manifest.base > manifest.latest || (manifest.base == 0) != (manifest.latest == 0))
+            throw std::runtime_error{
+                "CheckpointStore readManifest(), " + path + " is not a checkpoint manifest"};
+
+        if(manifest.valueSize != sizeof(T))
+            throw std::runtime_error{
+                "CheckpointStore readManifest(), " + path + " holds values of a different size"};
+
+        if(manifest.latest != m_latest || manifest.base != m_base)                          // the generations changed under this store, its tree's references cannot be trusted
+            m_treeId = 0;
+
+        m_base = manifest.base;
+        m_latest = manifest.latest;
+        return manifest;
+    }                                                                                       // readManifest function end //
+
+    template <typename T, typename Augmentation>
+    void CheckpointStore<T, Augmentation>::writeManifest(const CheckpointManifest& manifest)
+    {                                                                                       // writeManifest function start //
+        std::string path = m_prefix + ".manifest";
+        std::string temporary = path + ".tmp";
+
+        {
+            std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+            out.write(reinterpret_cast<const char*>(&manifest), sizeof(manifest));
+            out.close();
+
+            if(!out)
+                throw std::runtime_error{
+                    "CheckpointStore writeManifest(), cannot write " + temporary};
+        }
+
+        if(std::rename(temporary.c_str(), path.c_str()) != 0)                               // atomic on POSIX, readers see the old or the new manifest
+            throw std::runtime_error{
+                "CheckpointStore writeManifest(), cannot replace " + path};
+    }                                                                                       // writeManifest function end //
+}
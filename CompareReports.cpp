@@ -0,0 +1,72 @@
+// compares two reports written by AVLTreeBenchmark and marks the benchmarks that got slower
+//
+// build: g++ -O2 -std=c++17 CompareReports.cpp -o CompareReports
+// usage: CompareReports base.json candidate.json [threshold]
+// threshold is the relative slowdown that counts as a regression, 0.05 by default,
+// the exit status is 1 if any benchmark regressed by more than it, so a script can fail on it
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BenchmarkReport.h"
+
+namespace
+{
+    using namespace DataStructures;
+
+    BenchmarkReport readReport(const char* path)                                 // readReport function start //
+    {
+        std::ifstream in{path};
+        if(!in)
+            throw std::runtime_error{std::string{"CompareReports readReport(), could not open "} + path};
+        return BenchmarkReport::readJson(in);
+    }                                                                            // readReport function end //
+
+    void describe(const char* label, const HardwareInfo& hardware)               // describe function start //
+    {
+        std::cout << label << hardware.cpu << ", " << hardware.threads << " threads, " << hardware.compiler << '\n';
+    }                                                                            // describe function end //
+}
+
+int main(int argc, char** argv)                                                  // main function start //
+{
+    if(argc != 3 && argc != 4)
+    {
+        std::cerr << "usage: CompareReports base.json candidate.json [threshold]\n";
+        return 2;
+    }
+
+    try
+    {
+        BenchmarkReport base = readReport(argv[1]);
+        BenchmarkReport candidate = readReport(argv[2]);
+        double threshold = argc == 4 ? std::stod(argv[3]) : 0.05;
+
+        describe("base:      ", base.hardware);
+        describe("candidate: ", candidate.hardware);
+        if(base.hardware.cpu != candidate.hardware.cpu || base.hardware.compiler != candidate.hardware.compiler)
+            std::cout << "the reports come from different machines or compilers, differences are not only the code's\n";
+
+        std::vector<BenchmarkComparison> comparisons = compareReports(base, candidate);
+        printComparison(std::cout, comparisons, threshold);
+
+        if(comparisons.size() != base.results.size() || comparisons.size() != candidate.results.size())
+            std::cout << comparisons.size() << " benchmarks are in both reports, the others are skipped\n";
+
+        for(const BenchmarkComparison& comparison : comparisons)
+            if(comparison.regression(threshold))
+                return 1;
+    }
+    catch(const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        return 2;
+    }
+
+    return 0;
+}                                                                                // main function end //
@@ -0,0 +1,299 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // read only, compressed copy of a set of integer keys
+    // keys are cut into blocks of s_blockSize, each block stores its smallest key in a top level index
+    // and the gaps between its following keys bit packed with the smallest width that fits the block's largest gap
+    // dense or monotone ids therefore cost a few bits per key instead of a whole AVLTree node
+    template <class T>
+    class CompressedSnapshot
+    {
+        static_assert(std::is_integral<T>::value, "CompressedSnapshot only compresses integer keys");
+
+        static const std::size_t s_blockSize = 128;  // keys per block, the first one lives in m_minima
+
+        std::vector<T> m_minima;                     // smallest key of every block, sorted, searched to pick a block
+        std::vector<std::size_t> m_wordOffsets;      // index of each block's first word in m_words
+        std::vector<std::uint8_t> m_widths;          // bits used for every packed gap of each block, 0 if all gaps are 1
+        std::vector<std::uint64_t> m_words;          // packed gaps of all blocks, gap - 1 is stored since keys are unique
+        std::size_t m_size;                          // number of keys
+
+        public:
+
+        class ConstIterator                          // in order iterator, decodes one gap per step
+        {
+            friend class CompressedSnapshot<T>;
+
+            const CompressedSnapshot<T>* m_snapshot; // snapshot being iterated
+            std::size_t m_block;                     // current block
+            std::size_t m_index;                     // position inside the current block
+            T m_value;                               // current key
+
+            ConstIterator(const CompressedSnapshot<T>* snapshot, std::size_t block, std::size_t index, T value) :
+                m_snapshot{snapshot}, m_block{block}, m_index{index}, m_value{value}
+            {}
+
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            ConstIterator() : m_snapshot{nullptr}, m_block{0}, m_index{0}, m_value{} {}
+
+            const T& operator*() const { return m_value; }
+            const T* operator->() const { return &m_value; }
+
+            ConstIterator& operator++();             // moves to the next larger key
+            ConstIterator operator++(int);
+
+            bool operator==(const ConstIterator& other) const { return m_block == other.m_block && m_index == other.m_index; }
+            bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+        };
+
+        template <class InputIterator>
+        CompressedSnapshot(InputIterator first, InputIterator last); // builds a snapshot from strictly increasing keys, throws if they are not strictly increasing
+        template <class Augmentation>
+        explicit CompressedSnapshot(const AVLTree<T, Augmentation>&); // builds a snapshot of every key in the tree
+
+        ConstIterator find(const T&) const;          // trys to find a key, returns an iterator to it or end() if it is missing
+        bool contains(const T&) const;               // returns true if the key is in the snapshot
+        ConstIterator lowerBound(const T&) const;    // returns an iterator to the first key not less than the given key
+
+        ConstIterator begin() const;                 // returns an iterator to the smallest key
+        ConstIterator end() const;                   // returns the past the end iterator
+
+        bool empty() const { return m_size == 0; }   // returns true if the snapshot holds no keys
+        std::size_t size() const { return m_size; }  // returns the number of keys
+
+        std::size_t memoryUsage() const;             // returns the bytes used by the index and the packed blocks
+        double bitsPerKey() const;                   // returns memoryUsage() in bits divided by the number of keys
+
+        private:
+
+        std::size_t blockCount(std::size_t block) const;          // number of keys in the given block, only the last one can be short
+        std::uint64_t gap(std::size_t block, std::size_t index) const; // unpacks the stored gap in front of the key at index, index must be at least 1
+        std::size_t findBlock(const T&) const;                    // returns the block that would hold the key, m_minima.size() if it is smaller than every key
+
+        static std::uint8_t width(std::uint64_t);                 // number of bits needed to store the value
+    };
+
+    template <typename T>
+    template <class InputIterator>
+    CompressedSnapshot<T>::CompressedSnapshot(InputIterator first, InputIterator last) : m_size{0}  // range constructor start //
+    {
+        std::vector<std::uint64_t> gaps;                                                // gaps of the block being built
+        gaps.reserve(s_blockSize);
+
+        auto flush = [this, &gaps]()                                                    // packs the gaps of the finished block
+        {
+            std::uint64_t largest = 0;
+            for(std::uint64_t storedGap : gaps)
+                largest = std::max(largest, storedGap);
+
+            std::uint8_t bits = width(largest);
+            m_widths.push_back(bits);
+            m_wordOffsets.push_back(m_words.size());
+            m_words.resize(m_words.size() + (gaps.size() * bits + 63) / 64, 0);
+
+            std::uint64_t* words = m_words.data() + m_wordOffsets.back();
+            for(std::size_t i = 0; i < gaps.size() && bits != 0; ++i)
+            {
+                std::size_t position = i * bits;
+                std::size_t word = position / 64;
+                std::size_t shift = position % 64;
+
+                words[word] |= gaps[i] << shift;
+                if(shift + bits > 64)                                                   // the gap straddles two words
+                    words[word + 1] |= gaps[i] >> (64 - shift);
+            }
+
+            gaps.clear();
+        };
+
+        T previous{};
+        for(; first != last; ++first)
+        {
+            T key = *first;
+
+            if(m_size != 0 && !(previous < key))                                       // the gaps are stored unsigned, anything else would decode to garbage
+                throw std::runtime_error{
+                    "CompressedSnapshot CompressedSnapshot(), keys are not strictly increasing"};
+
+            if(m_size % s_blockSize == 0)                                               // first key of a new block goes into the index
+            {
+                if(m_size != 0)
+                    flush();
+                m_minima.push_back(key);
+            }
+
+            else
+                gaps.push_back(static_cast<std::uint64_t>(key) - static_cast<std::uint64_t>(previous) - 1);
+
+            previous = key;
+            ++m_size;
+        }
+
+        if(m_size != 0)
+            flush();
+    }                                                                                   // range constructor end //
+
+    template <typename T>
+    template <class Augmentation>
+    CompressedSnapshot<T>::CompressedSnapshot(const AVLTree<T, Augmentation>& tree) :   // tree constructor start //
+        CompressedSnapshot(tree.begin(), tree.end())
+    {}                                                                                  // tree constructor end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator CompressedSnapshot<T>::find(const T& key) const
+    {                                                              // find function start //
+        ConstIterator found = lowerBound(key);
+
+        if(found != end() && *found == key)
+            return found;
+        return end();                                              // return end() if the key is missing
+    }                                                              // find function end //
+
+    template <typename T>
+    bool CompressedSnapshot<T>::contains(const T& key) const       // contains function start //
+    {
+        return find(key) != end();
+    }                                                              // contains function end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator CompressedSnapshot<T>::lowerBound(const T& key) const
+    {                                                              // lowerBound function start //
+        std::size_t block = findBlock(key);
+        if(block == m_minima.size())                               // smaller than every key, the first key is the answer
+            return begin();
+
+        ConstIterator current{this, block, 0, m_minima[block]};
+        ConstIterator last = end();
+
+        while(current != last && *current < key)                   // at most one block is decoded
+            ++current;
+
+        return current;
+    }                                                              // lowerBound function end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator CompressedSnapshot<T>::begin() const
+    {                                                              // begin function start //
+        if(m_size == 0)
+            return end();
+        return ConstIterator{this, 0, 0, m_minima[0]};
+    }                                                              // begin function end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator CompressedSnapshot<T>::end() const
+    {                                                              // end function start //
+        return ConstIterator{this, m_minima.size(), 0, T{}};
+    }                                                              // end function end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator& CompressedSnapshot<T>::ConstIterator::operator++()
+    {                                                              // iterator increment function start //
+        ++m_index;
+
+        if(m_index < m_snapshot->blockCount(m_block))              // next key is in the same block
+            m_value = static_cast<T>(static_cast<std::uint64_t>(m_value) + m_snapshot->gap(m_block, m_index) + 1);
+
+        else                                                       // next key is the next block's minimum
+        {
+            ++m_block;
+            m_index = 0;
+
+            if(m_block < m_snapshot->m_minima.size())
+                m_value = m_snapshot->m_minima[m_block];
+        }
+
+        return *this;
+    }                                                              // iterator increment function end //
+
+    template <typename T>
+    typename CompressedSnapshot<T>::ConstIterator CompressedSnapshot<T>::ConstIterator::operator++(int)
+    {                                                              // iterator post increment function start //
+        ConstIterator previous{*this};
+        ++(*this);
+        return previous;
+    }                                                              // iterator post increment function end //
+
+    template <typename T>
+    std::size_t CompressedSnapshot<T>::memoryUsage() const        // memoryUsage function start //
+    {
+        return m_minima.size() * sizeof(T)
+             + m_wordOffsets.size() * sizeof(std::size_t)
+             + m_widths.size() * sizeof(std::uint8_t)
+             + m_words.size() * sizeof(std::uint64_t);
+    }                                                              // memoryUsage function end //
+
+    template <typename T>
+    double CompressedSnapshot<T>::bitsPerKey() const              // bitsPerKey function start //
+    {
+        if(m_size == 0)
+            return 0.0;
+        return 8.0 * static_cast<double>(memoryUsage()) / static_cast<double>(m_size);
+    }                                                              // bitsPerKey function end //
+
+    template <typename T>
+    std::size_t CompressedSnapshot<T>::blockCount(std::size_t block) const   // blockCount function start //
+    {
+        if(block + 1 < m_minima.size())
+            return s_blockSize;
+        return m_size - block * s_blockSize;                                 // the last block holds whatever is left
+    }                                                                        // blockCount function end //
+
+    template <typename T>
+    std::uint64_t CompressedSnapshot<T>::gap(std::size_t block, std::size_t index) const
+    {                                                                        // gap function start //
+        std::uint8_t bits = m_widths[block];
+        if(bits == 0)                                                        // every gap in the block is 1, nothing was stored
+            return 0;
+
+        const std::uint64_t* words = m_words.data() + m_wordOffsets[block];
+        std::size_t position = (index - 1) * bits;                           // gaps are stored for keys 1 - count-1
+        std::size_t word = position / 64;
+        std::size_t shift = position % 64;
+
+        std::uint64_t value = words[word] >> shift;
+        if(shift + bits > 64)                                                // the gap straddles two words
+            value |= words[word + 1] << (64 - shift);
+
+        if(bits == 64)
+            return value;
+        return value & ((std::uint64_t{1} << bits) - 1);
+    }                                                                        // gap function end //
+
+    template <typename T>
+    std::size_t CompressedSnapshot<T>::findBlock(const T& key) const         // findBlock function start //
+    {
+        auto after = std::upper_bound(m_minima.begin(), m_minima.end(), key); // first block that starts after the key
+        if(after == m_minima.begin())
+            return m_minima.size();
+        return static_cast<std::size_t>(after - m_minima.begin()) - 1;
+    }                                                                        // findBlock function end //
+
+    template <typename T>
+    std::uint8_t CompressedSnapshot<T>::width(std::uint64_t value)           // width function start //
+    {
+        std::uint8_t bits = 0;
+        while(value != 0)
+        {
+            ++bits;
+            value >>= 1;
+        }
+        return bits;
+    }                                                                        // width function end //
+}
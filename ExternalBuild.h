@@ -0,0 +1,358 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "AVLTree.h"
+#include "TreeImage.h"
+
+namespace DataStructures
+{
+    struct ExternalBuildStats
+    {
+        std::uint64_t records;                       // values passed to add()
+        std::uint64_t distinct;                      // values left after the merge dropped duplicates
+        std::size_t runs;                            // sorted runs written to disk, 0 if everything fit in the budget
+        std::uint64_t bytesIn;                       // bytes read from input streams
+        std::uint64_t runBytesWritten;               // bytes written to run files
+        std::uint64_t runBytesRead;                  // bytes read back from run files during the merge
+        double runSeconds;                           // time spent sorting and writing runs
+        double mergeSeconds;                         // time spent merging, including writing the output
+
+        double runWriteMBps() const { return runSeconds > 0 ? static_cast<double>(runBytesWritten) / runSeconds / 1e6 : 0; }  // run formation throughput
+        double mergeReadMBps() const { return mergeSeconds > 0 ? static_cast<double>(runBytesRead) / mergeSeconds / 1e6 : 0; } // merge throughput
+    };
+
+    // builds a tree from more unsorted values than fit in memory
+    // values are collected into a buffer sized by the memory budget, each full buffer is sorted and written to a run file,
+    // and the runs are then merged k ways with the budget split between their read buffers, duplicates are dropped like AVLTree::insert() would
+    // the merged values go either into an AVLTree, appended one by one as they come out of the merge, or into a tree image file,
+    // neither holds the merged values in a separate buffer, so building a tree needs memory for the tree and the run buffers only
+    template <class T>
+    class ExternalTreeBuilder
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ExternalTreeBuilder writes raw bytes of T to its run files");
+
+        struct Run                                   // one sorted run being merged
+        {
+            std::ifstream in;
+            std::vector<T> buffer;                   // values read ahead from the run
+            std::size_t position;                    // next value of buffer to merge
+            std::uint64_t remaining;                 // values of the run not read into buffer yet
+        };
+
+        std::string m_directory;                     // where run files are created
+        std::size_t m_budget;                        // bytes the buffers may use
+        std::vector<T> m_buffer;                     // values not in a run yet
+        std::vector<std::string> m_runPaths;         // run files written so far
+        std::vector<std::uint64_t> m_runCounts;      // values in each run
+        ExternalBuildStats m_stats;
+        bool m_merged;                               // the runs were consumed by build() or writeImage()
+
+        public:
+
+        ExternalTreeBuilder(const std::string& directory, std::size_t memoryBudget);   // run files go to directory, the budget is in bytes
+        ExternalTreeBuilder(const ExternalTreeBuilder<T>&) = delete;                   // copy constructor disabled
+        ~ExternalTreeBuilder();                                                        // deletes the run files
+
+        void add(const T&);                          // adds a value, writing a run when the buffer is full
+        void add(std::istream&);                     // adds every raw T record of the stream, reading it in budget sized chunks
+
+        template <class Augmentation>
+        void build(AVLTree<T, Augmentation>&);       // merges everything into the tree, replacing its contents, the tree itself must fit in memory, it is left empty if the merge fails
+        void writeImage(const std::string& path);    // merges everything into a tree image file
+
+        const ExternalBuildStats& stats() const { return m_stats; }   // returns the counters of the build so far
+
+        private:
+
+        void writeRun();                             // sorts the buffer and writes it as a new run
+        std::string createRunFile();                 // creates a new, uniquely named empty run file and records its path
+
+        template <class Function>
+        void merge(Function output);                 // calls output(value) for every distinct value in increasing order, can only run once
+
+        template <class Function>
+        void mergeRuns(std::size_t first, std::size_t last, Function output);   // merges runs [first, last) calling output(value) for every value, then deletes them
+
+        bool refill(Run&);                           // reads the next block of a run, returns false once it is exhausted
+
+        static const std::size_t s_maxFanIn = 256;   // most runs merged at once, more are merged in several passes to stay within open file limits
+    };
+
+    template <typename T>
+    ExternalTreeBuilder<T>::ExternalTreeBuilder(const std::string& directory, std::size_t memoryBudget) :
+        m_directory{directory}, m_budget{memoryBudget}, m_buffer{}, m_runPaths{}, m_runCounts{}, m_stats{}, m_merged{false}
+    {                                                                                           // constructor start //
+        if(m_budget < 2 * sizeof(T))
+            throw std::runtime_error{
+                "ExternalTreeBuilder ExternalTreeBuilder(), memory budget is too small"};
+
+        m_buffer.reserve(m_budget / sizeof(T));
+    }                                                                                           // constructor end //
+
+    template <typename T>
+    ExternalTreeBuilder<T>::~ExternalTreeBuilder()                                              // destructor start //
+    {
+        for(const std::string& path : m_runPaths)
+            std::remove(path.c_str());
+    }                                                                                           // destructor end //
+
+    template <typename T>
+    void ExternalTreeBuilder<T>::add(const T& value)                                            // add function start //
+    {
+        if(m_merged)
+            throw std::runtime_error{
+                "ExternalTreeBuilder add(), values were already merged"};
+
+        if(m_buffer.size() == m_buffer.capacity())
+            writeRun();
+
+        m_buffer.push_back(value);
+        ++m_stats.records;
+    }                                                                                           // add function end //
+
+    template <typename T>
+    void ExternalTreeBuilder<T>::add(std::istream& in)                                          // stream add function start //
+    {
+        if(m_merged)
+            throw std::runtime_error{
+                "ExternalTreeBuilder add(), values were already merged"};
+
+        while(in)
+        {
+            if(m_buffer.size() == m_buffer.capacity())
+                writeRun();
+
+            std::size_t free = m_buffer.capacity() - m_buffer.size();                           // read straight into the buffer's spare room
+            std::size_t used = m_buffer.size();
+            m_buffer.resize(m_buffer.capacity());
+
+            in.read(reinterpret_cast<char*>(m_buffer.data() + used), static_cast<std::streamsize>(free * sizeof(T)));
+            std::size_t bytes = static_cast<std::size_t>(in.gcount());
+
+            if(bytes % sizeof(T) != 0)
+                throw std::runtime_error{
+                    "ExternalTreeBuilder add(), stream ends in the middle of a record"};
+
+            m_buffer.resize(used + bytes / sizeof(T));
+            m_stats.bytesIn += bytes;
+            m_stats.records += bytes / sizeof(T);
+        }
+    }                                                                                           // stream add function end //
+
+    template <typename T>
+    template <class Augmentation>
+    void ExternalTreeBuilder<T>::build(AVLTree<T, Augmentation>& tree)                         // build function start //
+    {
+        tree.clear();
+
+        try
+        {
+            merge([&tree](const T& value) { tree.insert(value); });                            // increasing values take insert()'s append path, O(1) amortized each
+        }
+        catch(...)
+        {
+            tree.clear();                                                                       // do not leave a tree of some prefix of the values behind
+            throw;
+        }
+    }                                                                                           // build function end //
+
+    template <typename T>
+    void ExternalTreeBuilder<T>::writeImage(const std::string& path)                            // writeImage function start //
+    {
+        TreeImageWriter<T> writer{path};
+        merge([&writer](const T& value) { writer.append(value); });
+        writer.finish();
+    }                                                                                           // writeImage function end //
+
+    template <typename T>
+    void ExternalTreeBuilder<T>::writeRun()                                                     // writeRun function start //
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::sort(m_buffer.begin(), m_buffer.end());
+
+        std::string path = createRunFile();
+
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size() * sizeof(T)));
+
+        if(!out)
+            throw std::runtime_error{
+                "ExternalTreeBuilder writeRun(), cannot write " + path};
+
+        m_runCounts.push_back(m_buffer.size());
+        m_stats.runBytesWritten += m_buffer.size() * sizeof(T);
+        ++m_stats.runs;
+        m_buffer.clear();
+
+        m_stats.runSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }                                                                                           // writeRun function end //
+
+    template <typename T>
+    std::string ExternalTreeBuilder<T>::createRunFile()                                         // createRunFile function start //
+    {
+        std::string path = m_directory + "/avl-run-XXXXXX";                                     // mkstemp picks a name no other builder or process is using
+        int fd = mkstemp(&path[0]);
+
+        if(fd == -1)
+            throw std::runtime_error{
+                "ExternalTreeBuilder createRunFile(), cannot create a run file in " + m_directory};
+
+        close(fd);                                                                              // the file exists now, streams reopen it by name
+        m_runPaths.push_back(path);                                                             // recorded first so the destructor removes a half written run
+        return path;
+    }                                                                                           // createRunFile function end //
+
+    template <typename T>
+    template <class Function>
+    void ExternalTreeBuilder<T>::merge(Function output)                                         // merge function start //
+    {
+        if(m_merged)
+            throw std::runtime_error{
+                "ExternalTreeBuilder merge(), values were already merged"};
+        m_merged = true;
+
+        if(!m_runPaths.empty() && !m_buffer.empty())                                            // the tail becomes a run too, so every value is in one
+            writeRun();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool first = true;
+        T previous{};
+
+        auto emit = [&](const T& value)                                                         // drops values equal to the one before
+        {
+            if(first || previous < value)
+            {
+                output(value);
+                ++m_stats.distinct;
+            }
+            previous = value;
+            first = false;
+        };
+
+        if(m_runPaths.empty())                                                                  // everything fit in the budget, no disk needed
+        {
+            std::sort(m_buffer.begin(), m_buffer.end());
+            for(const T& value : m_buffer)
+                emit(value);
+            std::vector<T>{}.swap(m_buffer);
+        }
+        else
+        {
+            std::vector<T>{}.swap(m_buffer);                                                    // give the budget to the run buffers
+
+            std::size_t firstRun = 0;
+
+            while(m_runPaths.size() - firstRun > s_maxFanIn)                                    // too many open files, merge groups into longer runs first
+            {
+                std::string path = createRunFile();
+                std::ofstream out{path, std::ios::binary | std::ios::trunc};
+                std::uint64_t count = 0;
+
+                mergeRuns(firstRun, firstRun + s_maxFanIn, [&out, &count](const T& value)
+                {
+                    out.write(reinterpret_cast<const char*>(&value), sizeof(T));               // ofstream buffers these small writes
+                    ++count;
+                });
+
+                if(!out)
+                    throw std::runtime_error{
+                        "ExternalTreeBuilder merge(), cannot write " + path};
+
+                m_runCounts.push_back(count);
+                m_stats.runBytesWritten += count * sizeof(T);
+                firstRun += s_maxFanIn;
+            }
+
+            mergeRuns(firstRun, m_runPaths.size(), emit);
+        }
+
+        m_stats.mergeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }                                                                                           // merge function end //
+
+    template <typename T>
+    template <class Function>
+    void ExternalTreeBuilder<T>::mergeRuns(std::size_t first, std::size_t last, Function output)
+    {                                                                                           // mergeRuns function start //
+        std::size_t blockValues = std::max<std::size_t>(1, m_budget / sizeof(T) / (last - first));
+        std::vector<Run> runs(last - first);
+
+        for(std::size_t i = 0; i < runs.size(); ++i)
+        {
+            runs[i].in.open(m_runPaths[first + i], std::ios::binary);
+            if(!runs[i].in)
+                throw std::runtime_error{
+                    "ExternalTreeBuilder mergeRuns(), cannot open " + m_runPaths[first + i]};
+
+            runs[i].buffer.reserve(blockValues);
+            runs[i].position = 0;
+            runs[i].remaining = m_runCounts[first + i];
+        }
+
+        std::vector<std::size_t> heap;                                                          // run indexes, the run with the smallest current value on top
+        heap.reserve(runs.size());
+
+        auto greater = [&runs](std::size_t a, std::size_t b)
+        {
+            return runs[b].buffer[runs[b].position] < runs[a].buffer[runs[a].position];
+        };
+
+        for(std::size_t i = 0; i < runs.size(); ++i)
+            if(refill(runs[i]))
+                heap.push_back(i);
+
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        while(!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            Run& run = runs[heap.back()];
+
+            output(run.buffer[run.position]);
+
+            if(++run.position < run.buffer.size() || refill(run))
+                std::push_heap(heap.begin(), heap.end(), greater);
+            else
+                heap.pop_back();
+        }
+
+        for(std::size_t i = first; i < last; ++i)                                               // merged runs are not needed again, free the disk early
+        {
+            runs[i - first].in.close();
+            std::remove(m_runPaths[i].c_str());
+        }
+    }                                                                                           // mergeRuns function end //
+
+    template <typename T>
+    bool ExternalTreeBuilder<T>::refill(Run& run)                                               // refill function start //
+    {
+        if(run.remaining == 0)
+            return false;
+
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(run.remaining, run.buffer.capacity()));
+        run.buffer.resize(count);
+        run.in.read(reinterpret_cast<char*>(run.buffer.data()), static_cast<std::streamsize>(count * sizeof(T)));
+
+        if(!run.in)
+            throw std::runtime_error{
+                "ExternalTreeBuilder refill(), run file is truncated"};
+
+        run.position = 0;
+        run.remaining -= count;
+        m_stats.runBytesRead += count * sizeof(T);
+        return true;
+    }                                                                                           // refill function end //
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // AVLTree that freezes itself into a sorted array once it stops being modified
+    // every insert() or remove() restarts the quiet period, and after that many find() calls without a modification
+    // the values are moved into one contiguous array, freeing every node, the next insert() or remove() rebuilds the tree in O(n)
+    // a transition invalidates every pointer and iterator into the container, the transition hook is called after each one
+    template <class T, class Augmentation = NoAugmentation>
+    class FreezingAVLTree
+    {
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::ConstIterator TreeIterator;
+
+        Tree m_tree;                                 // mutable layout, empty while frozen
+        std::vector<T> m_frozen;                     // read only layout, the values in order, empty while thawed
+        bool m_isFrozen;                             // which layout holds the values
+        std::size_t m_quietPeriod;                   // find() calls without a modification before freezing, 0 never freezes automatically
+        std::size_t m_readsSinceWrite;               // find() calls since the last modification
+        std::size_t m_mutations;                     // insert() and remove() calls so far
+        std::size_t m_transitions;                   // freezes and thaws so far
+        std::function<void(bool frozen, std::size_t size)> m_hook;  // called after every transition, may be empty
+
+        public:
+
+        class ConstIterator                          // in order iterator over either layout
+        {
+            friend class FreezingAVLTree<T, Augmentation>;
+
+            const T* m_frozen;                       // current frozen value, nullptr in the tree layout
+            TreeIterator m_node;                     // current tree position, unused in the frozen layout
+
+            ConstIterator(const T* value, TreeIterator node) : m_frozen{value}, m_node{node} {}
+
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            ConstIterator() : m_frozen{nullptr}, m_node{} {}
+
+            const T& operator*() const { return m_frozen != nullptr ? *m_frozen : *m_node; }
+            const T* operator->() const { return &**this; }
+
+            ConstIterator& operator++()
+            {
+                if(m_frozen != nullptr)
+                    ++m_frozen;
+                else
+                    ++m_node;
+                return *this;
+            }
+
+            ConstIterator operator++(int)
+            {
+                ConstIterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const ConstIterator& other) const { return m_frozen == other.m_frozen && m_node == other.m_node; }
+            bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+        };
+
+        explicit FreezingAVLTree(std::size_t quietPeriod = 1 << 20);     // constructor, the tree starts thawed
+        FreezingAVLTree(const FreezingAVLTree&) = delete;                // copy constructor disabled
+
+        T* insert(const T&);                         // thaws if the value is new, then inserts like AVLTree::insert(), a value already present leaves a frozen tree frozen
+        T remove(const T&);                          // thaws if the value is present, then removes like AVLTree::remove(), a missing value throws without thawing
+
+        const T* find(const T&);                     // trys to find an element, counts toward the quiet period and may freeze the tree first
+        const T* find(const T&) const;               // const version of find, never causes a transition
+
+        ConstIterator begin() const;                 // returns an iterator to the smallest value
+        ConstIterator end() const;                   // returns the past the end iterator
+        ConstIterator lowerBound(const T&) const;    // returns an iterator to the first value not less than the given value
+
+        void freeze();                               // moves the values into the frozen layout now
+        void thaw();                                 // moves the values back into the tree now
+
+        void setQuietPeriod(std::size_t quietPeriod) { m_quietPeriod = quietPeriod; }   // sets the number of unmodified find() calls before freezing, 0 disables automatic freezing
+        void setTransitionHook(std::function<void(bool frozen, std::size_t size)> hook) { m_hook = std::move(hook); } // sets the function called after every freeze and thaw
+
+        bool isFrozen() const { return m_isFrozen; }                                    // returns true while the values are in the frozen layout
+        bool empty() const { return size() == 0; }                                      // returns true if there are no values
+        std::size_t size() const { return m_isFrozen ? m_frozen.size() : m_tree.size(); } // returns the number of values
+        std::size_t mutations() const { return m_mutations; }                           // returns the number of insert() and remove() calls so far
+        std::size_t transitions() const { return m_transitions; }                       // returns the number of freezes and thaws so far
+    };
+
+    template <typename T, typename Augmentation>
+    FreezingAVLTree<T, Augmentation>::FreezingAVLTree(std::size_t quietPeriod) : // constructor start //
+        m_tree{}, m_frozen{}, m_isFrozen{false}, m_quietPeriod{quietPeriod}, m_readsSinceWrite{0},
+        m_mutations{0}, m_transitions{0}, m_hook{}
+    {}                                                                                  // constructor end //
+
+    template <typename T, typename Augmentation>
+    T* FreezingAVLTree<T, Augmentation>::insert(const T& newValue)          // insert function start //
+    {
+        if(m_isFrozen)
+        {
+            typename std::vector<T>::iterator found = std::lower_bound(m_frozen.begin(), m_frozen.end(), newValue);
+
+            if(found != m_frozen.end() && !(newValue < *found))             // nothing to insert, no reason to pay for a thaw
+            {
+                ++m_mutations;
+                return &(*found);
+            }
+
+            thaw();
+        }
+
+        ++m_mutations;
+        m_readsSinceWrite = 0;
+        return m_tree.insert(newValue);
+    }                                                                       // insert function end //
+
+    template <typename T, typename Augmentation>
+    T FreezingAVLTree<T, Augmentation>::remove(const T& value)              // remove function start //
+    {
+        if(m_isFrozen)
+        {
+            typename std::vector<T>::const_iterator found = std::lower_bound(m_frozen.begin(), m_frozen.end(), value);
+
+            if(found == m_frozen.end() || value < *found)                   // nothing to remove, no reason to pay for a thaw
+            {
+                ++m_mutations;
+                throw std::runtime_error{
+                    "FreezingAVLTree remove(), cannot remove value, value does not exist"};
+            }
+
+            thaw();
+        }
+
+        ++m_mutations;
+        m_readsSinceWrite = 0;
+        return m_tree.remove(value);
+    }                                                                       // remove function end //
+
+    template <typename T, typename Augmentation>
+    const T* FreezingAVLTree<T, Augmentation>::find(const T& value)         // find function start //
+    {
+        if(!m_isFrozen && m_quietPeriod != 0 && ++m_readsSinceWrite >= m_quietPeriod)  // quiet for long enough
+            freeze();
+
+        return static_cast<const FreezingAVLTree<T, Augmentation>&>(*this).find(value);
+    }                                                                       // find function end //
+
+    template <typename T, typename Augmentation>
+    const T* FreezingAVLTree<T, Augmentation>::find(const T& value) const   // const find function start //
+    {
+        if(!m_isFrozen)
+            return m_tree.find(value);
+
+        typename std::vector<T>::const_iterator found = std::lower_bound(m_frozen.begin(), m_frozen.end(), value);
+
+        if(found == m_frozen.end() || value < *found)
+            return nullptr;
+        return &(*found);
+    }                                                                       // const find function end //
+
+    template <typename T, typename Augmentation>
+    typename FreezingAVLTree<T, Augmentation>::ConstIterator FreezingAVLTree<T, Augmentation>::begin() const
+    {                                                                       // begin function start //
+        if(!m_isFrozen)
+            return ConstIterator{nullptr, m_tree.begin()};
+
+        if(m_frozen.empty())
+            return end();
+        return ConstIterator{m_frozen.data(), TreeIterator{}};
+    }                                                                       // begin function end //
+
+    template <typename T, typename Augmentation>
+    typename FreezingAVLTree<T, Augmentation>::ConstIterator FreezingAVLTree<T, Augmentation>::end() const
+    {                                                                       // end function start //
+        if(!m_isFrozen || m_frozen.empty())
+            return ConstIterator{};
+        return ConstIterator{m_frozen.data() + m_frozen.size(), TreeIterator{}};
+    }                                                                       // end function end //
+
+    template <typename T, typename Augmentation>
+    typename FreezingAVLTree<T, Augmentation>::ConstIterator FreezingAVLTree<T, Augmentation>::lowerBound(const T& value) const
+    {                                                                       // lowerBound function start //
+        if(!m_isFrozen)
+            return ConstIterator{nullptr, m_tree.lowerBound(value)};
+
+        typename std::vector<T>::const_iterator found = std::lower_bound(m_frozen.begin(), m_frozen.end(), value);
+
+        if(found == m_frozen.end())
+            return end();
+        return ConstIterator{&(*found), TreeIterator{}};
+    }                                                                       // lowerBound function end //
+
+    template <typename T, typename Augmentation>
+    void FreezingAVLTree<T, Augmentation>::freeze()                         // freeze function start //
+    {
+        if(m_isFrozen)
+            return;
+
+        std::vector<T> values;
+        values.reserve(m_tree.size());
+        values.assign(m_tree.begin(), m_tree.end());
+
+        m_frozen.swap(values);
+        m_tree.clear();
+        m_isFrozen = true;
+        ++m_transitions;
+
+        if(m_hook)
+            m_hook(true, m_frozen.size());
+    }                                                                       // freeze function end //
+
+    template <typename T, typename Augmentation>
+    void FreezingAVLTree<T, Augmentation>::thaw()                           // thaw function start //
+    {
+        if(!m_isFrozen)
+            return;
+
+        m_tree.buildSorted(m_frozen);                                       // the frozen values are sorted and distinct
+        std::vector<T>{}.swap(m_frozen);                                    // give the array's memory back, not just its values
+        m_isFrozen = false;
+        m_readsSinceWrite = 0;
+        ++m_transitions;
+
+        if(m_hook)
+            m_hook(false, m_tree.size());
+    }                                                                       // thaw function end //
+}
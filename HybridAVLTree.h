@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // AVLTree with an open addressing hash index over its values
+    // exact matches are answered by the hash index in O(1) expected time, ordered scans still go through the tree
+    // the index stores pointers to the values inside the tree's nodes, which stay put until their value is removed
+    template <class T, class Hash = std::hash<T>, class Augmentation = NoAugmentation>
+    class HybridAVLTree
+    {
+        typedef AVLTree<T, Augmentation> Tree;
+
+        Tree m_tree;                                 // ordered storage, owns the values
+        std::vector<T*> m_slots;                     // linear probing table of pointers into m_tree, nullptr marks an empty slot, size is a power of two
+        Hash m_hash;                                 // hash function for T, equal values must hash equally
+
+        public:
+
+        typedef typename Tree::ConstIterator ConstIterator;
+
+        HybridAVLTree();                                            // constructor
+        HybridAVLTree(const HybridAVLTree&) = delete;               // copy constructor disabled
+
+        T* insert(const T&);                         // insert an element, returns a pointer to an element if it already exists, otherwise returns nullptr
+        T remove(const T&);                          // remove an element, returns the value removed, if it does not exist an exception is thrown
+
+        T* find(const T&);                           // trys to find an element through the hash index, returns a pointer to it or nullptr
+        const T* find(const T&) const;               // const version of find
+
+        ConstIterator begin() const { return m_tree.begin(); }                           // returns an iterator to the smallest value
+        ConstIterator end() const { return m_tree.end(); }                               // returns the past the end iterator
+        ConstIterator lowerBound(const T& value) const { return m_tree.lowerBound(value); } // returns an iterator to the first value not less than value
+
+        bool empty() const { return m_tree.empty(); }                // returns true if the container is empty
+        std::size_t size() const { return m_tree.size(); }           // returns the number of elements
+
+        const Tree& tree() const { return m_tree; }                  // returns the underlying tree
+        std::size_t indexBytes() const;                              // returns the memory used by the hash index on top of the tree
+        double loadFactor() const;                                   // returns the fraction of hash slots in use
+
+        private:
+
+        std::size_t home(const T&) const;            // returns the first slot probed for the value
+        std::size_t slotOf(const T&) const;          // returns the slot holding the value, or the empty slot where it would go
+        void grow();                                 // doubles the table and reinserts every pointer
+    };
+
+    template <typename T, typename Hash, typename Augmentation>
+    HybridAVLTree<T, Hash, Augmentation>::HybridAVLTree() :                 // constructor start //
+        m_tree{}, m_slots(16, nullptr), m_hash{}
+    {}                                                                      // constructor end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    T* HybridAVLTree<T, Hash, Augmentation>::insert(const T& newValue)      // insert function start //
+    {
+        std::size_t slot = slotOf(newValue);
+        if(m_slots[slot] != nullptr)                                        // already indexed, so already in the tree
+            return m_slots[slot];
+
+        if(2 * (m_tree.size() + 1) > m_slots.size())                        // keep the load factor at or below one half, grown before the tree changes
+        {                                                                   // so a failed allocation leaves both as they were
+            grow();
+            slot = slotOf(newValue);
+        }
+
+        T* inserted;
+        m_tree.insert(newValue, inserted);                                  // not in the index, so not in the tree either
+        m_slots[slot] = inserted;                                           // the empty slot at the end of the probe sequence
+        return nullptr;                                                     // return nullptr for a successful insertion
+    }                                                                       // insert function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    T HybridAVLTree<T, Hash, Augmentation>::remove(const T& value)          // remove function start //
+    {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t hole = slotOf(value);
+
+        if(m_slots[hole] == nullptr)                                        // not indexed, so not in the tree either
+            throw std::runtime_error{
+                "HybridAVLTree remove(), cannot remove value, value does not exist"};
+
+        T removed = m_tree.remove(value);                                   // the slot's pointer dangles from here on
+        m_slots[hole] = nullptr;
+
+        for(std::size_t slot = (hole + 1) & mask; m_slots[slot] != nullptr; slot = (slot + 1) & mask)
+        {
+            std::size_t start = home(*m_slots[slot]);                       // shift back entries whose probe sequence crossed the hole
+
+            if(((slot - start) & mask) >= ((slot - hole) & mask))
+            {
+                m_slots[hole] = m_slots[slot];
+                m_slots[slot] = nullptr;
+                hole = slot;
+            }
+        }
+
+        return removed;
+    }                                                                       // remove function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    T* HybridAVLTree<T, Hash, Augmentation>::find(const T& value)           // find function start //
+    {
+        return m_slots[slotOf(value)];                                      // nullptr if the probe ended at an empty slot
+    }                                                                       // find function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    const T* HybridAVLTree<T, Hash, Augmentation>::find(const T& value) const
+    {                                                                       // const find function start //
+        return m_slots[slotOf(value)];
+    }                                                                       // const find function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    std::size_t HybridAVLTree<T, Hash, Augmentation>::indexBytes() const    // indexBytes function start //
+    {
+        return m_slots.capacity() * sizeof(T*);
+    }                                                                       // indexBytes function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    double HybridAVLTree<T, Hash, Augmentation>::loadFactor() const         // loadFactor function start //
+    {
+        return static_cast<double>(m_tree.size()) / static_cast<double>(m_slots.size());
+    }                                                                       // loadFactor function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    std::size_t HybridAVLTree<T, Hash, Augmentation>::home(const T& value) const
+    {                                                                       // home function start //
+        std::uint64_t mixed = static_cast<std::uint64_t>(m_hash(value)) * 0x9e3779b97f4a7c15; // std::hash is often the identity, spread the bits before masking
+        return static_cast<std::size_t>(mixed ^ (mixed >> 32)) & (m_slots.size() - 1);
+    }                                                                       // home function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    std::size_t HybridAVLTree<T, Hash, Augmentation>::slotOf(const T& value) const
+    {                                                                       // slotOf function start //
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t slot = home(value);
+
+        while(m_slots[slot] != nullptr && !(*m_slots[slot] == value))      // probe until the value or an empty slot, the table is never full
+            slot = (slot + 1) & mask;
+
+        return slot;
+    }                                                                       // slotOf function end //
+
+    template <typename T, typename Hash, typename Augmentation>
+    void HybridAVLTree<T, Hash, Augmentation>::grow()                       // grow function start //
+    {
+        std::vector<T*> old(2 * m_slots.size(), nullptr);
+        old.swap(m_slots);
+
+        for(T* value : old)
+            if(value != nullptr)
+                m_slots[slotOf(*value)] = value;
+    }                                                                       // grow function end //
+}
@@ -0,0 +1,287 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+#include "ParallelLoad.h"
+#include "TreeImage.h"
+
+namespace DataStructures
+{
+    // read only tree over a tree image that loads nodes when a search first reaches them
+    // the image is a sorted array, so the subtree over any range of it is known before it is read, a missing child is a stub for its range,
+    // a search reads one value per level until the range under it fits in a block, which is then read and built whole,
+    // so opening costs one header read and the first find() about log2(n / s_blockValues) small reads whatever the size of the image
+    // scans only load the nodes on the search path to their first value, the values in range are read sequentially
+    // the tree cannot be modified, load() builds a regular AVLTree from the image for that
+    // find() and scan() change the cached nodes and the file position, so one LazyAVLTree must not be used from several threads at once
+    template <class T>
+    class LazyAVLTree
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "LazyAVLTree reads raw bytes of T");
+
+        struct Node
+        {
+            T value;
+            Node* left;                              // nullptr if not loaded yet or if the left range is empty
+            Node* right;                             // nullptr if not loaded yet or if the right range is empty
+            std::uint64_t first;                     // index of the first value of the subtree in the image
+            std::uint64_t last;                      // index past its last value, the node's own value is at the middle
+        };
+
+        std::string m_path;                          // image the tree reads
+        std::ifstream m_in;                          // opened once, positioned for every read
+        std::uint64_t m_size;                        // values in the image
+        Node* m_root;                                // nullptr until the first search or if the image is empty
+
+        std::size_t m_nodes;                         // nodes built so far
+        std::uint64_t m_reads;                       // reads issued so far
+        std::uint64_t m_bytesRead;                   // bytes those reads returned
+
+        public:
+
+        explicit LazyAVLTree(const std::string& path); // opens the image and reads its header, throws if it is not an image of T
+        LazyAVLTree(const LazyAVLTree<T>&) = delete;   // copy constructor disabled
+        ~LazyAVLTree();                                // destructor
+
+        const T* find(const T&);                     // trys to find an element given a value, loading the nodes on its path, returns nullptr if it does not exist
+        bool contains(const T& value) { return find(value) != nullptr; }   // returns true if the value is in the image
+
+        template <class Function>
+        void scan(const T& low, const T& high, Function report); // calls report(value) for every value in [low, high] in increasing order, the search for low loads nodes, the values are read sequentially
+
+        template <class Augmentation>
+        void load(AVLTree<T, Augmentation>&, std::size_t threads = 0) const; // replaces the tree's contents with every value of the image, for callers that need to modify them
+
+        bool empty() const { return m_size == 0; }   // returns true if the image holds no values
+        std::size_t size() const { return static_cast<std::size_t>(m_size); } // returns the number of values
+
+        std::size_t materialized() const { return m_nodes; }     // returns the number of nodes loaded so far
+        std::uint64_t reads() const { return m_reads; }          // returns the number of reads issued so far
+        std::uint64_t bytesRead() const { return m_bytesRead; }  // returns the bytes read so far, header excluded
+
+        private:
+
+        Node* child(Node*, bool right, const T* low, const T* high); // returns the child, loading it if it is a stub, low and high bound its values exclusively
+        Node* loadRange(std::uint64_t first, std::uint64_t last, const T* low, const T* high); // loads the root of the range, or all of it if it fits in a block
+        Node* buildBlock(const T* values, std::uint64_t first, std::uint64_t last, std::uint64_t base); // builds every node of [first, last) from values holding the image from base on
+
+        void read(std::uint64_t first, std::uint64_t count, T* values); // reads count values from index first
+
+        static const std::uint64_t s_blockValues = 4096 / sizeof(T) < 2 ? 2 : 4096 / sizeof(T); // ranges of at most this many values are read and built in one go
+        static const std::uint64_t s_scanValues = 1 << 14;                                      // values read at once by scan()
+    };
+
+    template <typename T>
+    LazyAVLTree<T>::LazyAVLTree(const std::string& path) :
+        m_path{path}, m_in{path, std::ios::binary}, m_size{0}, m_root{nullptr}, m_nodes{0}, m_reads{0}, m_bytesRead{0}
+    {                                                                                   // constructor start //
+        if(!m_in)
+            throw std::runtime_error{
+                "LazyAVLTree LazyAVLTree(), cannot open " + path};
+
+        m_size = readTreeImageHeader<T>(m_in, path);
+    }                                                                                   // constructor end //
+
+    template <typename T>
+    LazyAVLTree<T>::~LazyAVLTree()                                                      // destructor start //
+    {
+        std::vector<Node*> stack;
+        if(m_root != nullptr)
+            stack.push_back(m_root);
+
+        while(!stack.empty())
+        {
+            Node* current = stack.back();
+            stack.pop_back();
+
+            if(current->left != nullptr)
+                stack.push_back(current->left);
+
+            if(current->right != nullptr)
+                stack.push_back(current->right);
+
+            delete current;
+        }
+    }                                                                                   // destructor end //
+
+    template <typename T>
+    const T* LazyAVLTree<T>::find(const T& value)                                       // find function start //
+    {
+        if(m_root == nullptr)
+        {
+            if(m_size == 0)
+                return nullptr;
+            m_root = loadRange(0, m_size, nullptr, nullptr);
+        }
+
+        const T* low = nullptr;                                                         // bounds of the current subtree, checked as stubs load
+        const T* high = nullptr;
+
+        for(Node* currentNode = m_root; currentNode != nullptr;)
+        {
+            if(value < currentNode->value)
+            {
+                high = &currentNode->value;
+                currentNode = child(currentNode, false, low, high);
+            }
+
+            else if(currentNode->value < value)
+            {
+                low = &currentNode->value;
+                currentNode = child(currentNode, true, low, high);
+            }
+
+            else
+                return &currentNode->value;
+        }
+
+        return nullptr;
+    }                                                                                   // find function end //
+
+    template <typename T>
+    template <class Function>
+    void LazyAVLTree<T>::scan(const T& low, const T& high, Function report)            // scan function start //
+    {
+        if(high < low || m_size == 0)
+            return;
+
+        if(m_root == nullptr)
+            m_root = loadRange(0, m_size, nullptr, nullptr);
+
+        std::uint64_t first = m_size;                                                   // index of the first value not below low, found by a search that loads its path
+        const T* lowBound = nullptr;
+        const T* highBound = nullptr;
+
+        for(Node* currentNode = m_root; currentNode != nullptr;)
+        {
+            if(currentNode->value < low)
+            {
+                lowBound = &currentNode->value;
+                currentNode = child(currentNode, true, lowBound, highBound);
+            }
+
+            else
+            {
+                first = currentNode->first + (currentNode->last - currentNode->first) / 2;
+                highBound = &currentNode->value;
+                currentNode = child(currentNode, false, lowBound, highBound);
+            }
+        }
+
+        std::vector<T> buffer;
+        bool started = false;
+        T previous{};
+
+        for(std::uint64_t index = first; index < m_size; index += buffer.size())
+        {
+            buffer.resize(static_cast<std::size_t>(std::min<std::uint64_t>(std::uint64_t{s_scanValues}, m_size - index)));
+            read(index, buffer.size(), buffer.data());
+
+            for(const T& value : buffer)
+            {
+                if(high < value)
+                    return;
+
+                if(started && !(previous < value))
+                    throw std::runtime_error{
+                        "LazyAVLTree scan(), values are not strictly increasing"};
+
+                report(value);
+                previous = value;
+                started = true;
+            }
+        }
+    }                                                                                   // scan function end //
+
+    template <typename T>
+    template <class Augmentation>
+    void LazyAVLTree<T>::load(AVLTree<T, Augmentation>& tree, std::size_t threads) const
+    {                                                                                   // load function start //
+        ParallelImageLoader<T, Augmentation>::load(m_path, tree, threads);
+    }                                                                                   // load function end //
+
+    template <typename T>
+    typename LazyAVLTree<T>::Node* LazyAVLTree<T>::child(Node* node, bool right, const T* low, const T* high)
+    {                                                                                   // child function start //
+        Node*& slot = right ? node->right : node->left;
+        if(slot != nullptr)
+            return slot;
+
+        std::uint64_t middle = node->first + (node->last - node->first) / 2;
+        std::uint64_t first = right ? middle + 1 : node->first;
+        std::uint64_t last = right ? node->last : middle;
+
+        if(first == last)                                                               // no stub, the child really is empty
+            return nullptr;
+
+        slot = loadRange(first, last, low, high);
+        return slot;
+    }                                                                                   // child function end //
+
+    template <typename T>
+    typename LazyAVLTree<T>::Node* LazyAVLTree<T>::loadRange(std::uint64_t first, std::uint64_t last, const T* low, const T* high)
+    {                                                                                   // loadRange function start //
+        if(last - first <= s_blockValues)                                               // small enough, one read builds the rest of this subtree
+        {
+            std::vector<T> values(static_cast<std::size_t>(last - first));
+            read(first, values.size(), values.data());
+
+            for(std::size_t i = 0; i < values.size(); ++i)
+                if((i == 0 && low != nullptr && !(*low < values[i])) ||
+                   (i != 0 && !(values[i - 1] < values[i])) ||
+                   (i + 1 == values.size() && high != nullptr && !(values[i] < *high)))
+                    throw std::runtime_error{
+                        "LazyAVLTree loadRange(), values are not strictly increasing"};
+
+            return buildBlock(values.data(), first, last, first);
+        }
+
+        std::uint64_t middle = first + (last - first) / 2;                              // same middle as AVLTree::buildNodes()
+        T value{};
+        read(middle, 1, &value);
+
+        if((low != nullptr && !(*low < value)) || (high != nullptr && !(value < *high)))
+            throw std::runtime_error{
+                "LazyAVLTree loadRange(), values are not strictly increasing"};
+
+        ++m_nodes;
+        return new Node{value, nullptr, nullptr, first, last};
+    }                                                                                   // loadRange function end //
+
+    template <typename T>
+    typename LazyAVLTree<T>::Node* LazyAVLTree<T>::buildBlock(const T* values, std::uint64_t first, std::uint64_t last, std::uint64_t base)
+    {                                                                                   // buildBlock function start //
+        if(first == last)
+            return nullptr;
+
+        std::uint64_t middle = first + (last - first) / 2;
+        Node* node = new Node{values[middle - base], nullptr, nullptr, first, last};
+        ++m_nodes;
+
+        node->left = buildBlock(values, first, middle, base);
+        node->right = buildBlock(values, middle + 1, last, base);
+        return node;
+    }                                                                                   // buildBlock function end //
+
+    template <typename T>
+    void LazyAVLTree<T>::read(std::uint64_t first, std::uint64_t count, T* values)     // read function start //
+    {
+        m_in.clear();
+        m_in.seekg(static_cast<std::streamoff>(sizeof(TreeImageHeader) + first * sizeof(T)));
+        m_in.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+
+        if(!m_in)
+            throw std::runtime_error{
+                "LazyAVLTree read(), " + m_path + " is truncated"};
+
+        ++m_reads;
+        m_bytesRead += count * sizeof(T);
+    }                                                                                   // read function end //
+}
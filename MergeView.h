@@ -0,0 +1,162 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // ordered view over the values of several AVLTrees, merged lazily with a binary heap of per tree iterators
+    // nothing is copied, the heap is allocated once when iteration starts and every step only moves one tree's iterator
+    // the trees must not be modified while the view is iterated
+    template <class T, class Augmentation = NoAugmentation>
+    class MergeView
+    {
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::ConstIterator TreeIterator;
+
+        std::vector<const Tree*> m_trees;            // trees being merged
+        bool m_deduplicate;                          // if true values present in several trees are yielded once
+        bool m_bounded;                              // if true only values in [m_low, m_high) are yielded
+        T m_low;
+        T m_high;
+
+        public:
+
+        class ConstIterator
+        {
+            friend class MergeView<T, Augmentation>;
+
+            std::vector<TreeIterator> m_heap;        // current position of every tree that still has values, smallest on top
+            bool m_deduplicate;
+            bool m_bounded;
+            T m_high;
+
+            ConstIterator(const MergeView&);         // starts iterating the view, end() is a default constructed iterator
+
+            void siftDown(std::size_t);              // restores the heap below the given slot
+            void advanceTop();                       // moves the smallest tree's iterator, dropping the tree once it runs out
+
+            public:
+
+            typedef std::input_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            ConstIterator() : m_heap{}, m_deduplicate{false}, m_bounded{false}, m_high{} {}
+
+            const T& operator*() const { return *m_heap.front(); }
+            const T* operator->() const { return &(*m_heap.front()); }
+
+            ConstIterator& operator++();             // moves to the next value in merged order
+
+            bool operator==(const ConstIterator& other) const;
+            bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+        };
+
+        explicit MergeView(std::vector<const Tree*> trees, bool deduplicate = true);                    // merges every value of the trees
+        MergeView(std::vector<const Tree*> trees, const T& low, const T& high, bool deduplicate = true); // merges the values in [low, high)
+
+        ConstIterator begin() const { return ConstIterator{*this}; } // returns an iterator to the smallest value
+        ConstIterator end() const { return ConstIterator{}; }        // returns the past the end iterator
+    };
+
+    template <typename T, typename Augmentation>
+    MergeView<T, Augmentation>::MergeView(std::vector<const Tree*> trees, bool deduplicate) :             // constructor start //
+        m_trees{trees}, m_deduplicate{deduplicate}, m_bounded{false}, m_low{}, m_high{}
+    {}                                                                                                    // constructor end //
+
+    template <typename T, typename Augmentation>
+    MergeView<T, Augmentation>::MergeView(std::vector<const Tree*> trees, const T& low, const T& high, bool deduplicate) :
+        m_trees{trees}, m_deduplicate{deduplicate}, m_bounded{true}, m_low{low}, m_high{high}             // bounded constructor start //
+    {}                                                                                                    // bounded constructor end //
+
+    template <typename T, typename Augmentation>
+    MergeView<T, Augmentation>::ConstIterator::ConstIterator(const MergeView& view) :                     // iterator constructor start //
+        m_heap{}, m_deduplicate{view.m_deduplicate}, m_bounded{view.m_bounded}, m_high{view.m_high}
+    {
+        m_heap.reserve(view.m_trees.size());                                                              // the only allocation of the whole merge
+
+        for(const Tree* tree : view.m_trees)
+        {
+            TreeIterator first = view.m_bounded ? tree->lowerBound(view.m_low) : tree->begin();
+
+            if(first != tree->end() && !(m_bounded && !(*first < m_high)))                               // skip trees with nothing in range
+                m_heap.push_back(first);
+        }
+
+        for(std::size_t i = m_heap.size() / 2; i-- > 0;)                                                 // build the heap bottom up
+            siftDown(i);
+    }                                                                                                     // iterator constructor end //
+
+    template <typename T, typename Augmentation>
+    typename MergeView<T, Augmentation>::ConstIterator& MergeView<T, Augmentation>::ConstIterator::operator++()
+    {                                                                                  // iterator increment function start //
+        if(!m_deduplicate)
+        {
+            advanceTop();
+            return *this;
+        }
+
+        const T* previous = &*m_heap.front();                                          // advanceTop() only moves an iterator, the value stays in its node
+        advanceTop();
+
+        while(!m_heap.empty() && !(*previous < *m_heap.front()))                       // other trees holding the same value
+            advanceTop();
+
+        return *this;
+    }                                                                                  // iterator increment function end //
+
+    template <typename T, typename Augmentation>
+    bool MergeView<T, Augmentation>::ConstIterator::operator==(const ConstIterator& other) const
+    {                                                                                  // iterator equality function start //
+        if(m_heap.empty() || other.m_heap.empty())                                     // end is only equal to another finished iterator
+            return m_heap.empty() && other.m_heap.empty();
+        return m_heap.front() == other.m_heap.front();
+    }                                                                                  // iterator equality function end //
+
+    template <typename T, typename Augmentation>
+    void MergeView<T, Augmentation>::ConstIterator::siftDown(std::size_t slot)         // siftDown function start //
+    {
+        std::size_t count = m_heap.size();
+
+        while(true)
+        {
+            std::size_t smallest = slot;
+            std::size_t left = 2 * slot + 1;
+            std::size_t right = left + 1;
+
+            if(left < count && *m_heap[left] < *m_heap[smallest])
+                smallest = left;
+
+            if(right < count && *m_heap[right] < *m_heap[smallest])
+                smallest = right;
+
+            if(smallest == slot)                                                       // both children are larger, the heap is restored
+                return;
+
+            std::swap(m_heap[slot], m_heap[smallest]);
+            slot = smallest;
+        }
+    }                                                                                  // siftDown function end //
+
+    template <typename T, typename Augmentation>
+    void MergeView<T, Augmentation>::ConstIterator::advanceTop()                       // advanceTop function start //
+    {
+        TreeIterator& top = m_heap.front();
+        ++top;
+
+        if(top == TreeIterator{} || (m_bounded && !(*top < m_high)))                   // this tree is done, move the last tree to the top
+        {
+            top = m_heap.back();
+            m_heap.pop_back();
+        }
+
+        if(!m_heap.empty())
+            siftDown(0);
+    }                                                                                  // advanceTop function end //
+}
@@ -0,0 +1,319 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    enum class TraceOperation : std::uint8_t
+    {
+        Insert,
+        Remove,
+        Find
+    };
+
+    struct TraceRecord
+    {
+        TraceOperation operation;                    // which call was made
+        std::uint64_t key;                           // key passed to the call, encoded so unsigned order matches the key's order
+    };
+
+    // in memory log of insert, remove and find calls with a compact binary file format
+    // every record is written as one operation byte followed by the zigzag varint difference to the previous key
+    class OperationTrace
+    {
+        std::vector<TraceRecord> m_records;          // recorded calls in the order they were made
+
+        public:
+
+        template <class T>
+        static std::uint64_t encode(const T&);       // maps an integer key to an unsigned value with the same order
+        template <class T>
+        static T decode(std::uint64_t);              // reverses encode()
+
+        void record(TraceOperation, std::uint64_t key);  // appends a call
+        void clear() { m_records.clear(); }              // forgets every call
+
+        void remapKeys();                            // replaces every key by its rank among the distinct keys, hiding the values but keeping their order
+
+        const std::vector<TraceRecord>& records() const { return m_records; } // returns the recorded calls
+        std::size_t size() const { return m_records.size(); }                  // returns the number of recorded calls
+
+        void write(std::ostream&) const;             // writes the trace in the binary format
+        static OperationTrace read(std::istream&);   // reads a trace written by write(), throws if the stream does not hold one
+
+        private:
+
+        static const std::uint64_t s_magic = 0x45434152544c5641; // "AVLTRACE"
+    };
+
+    // AVLTree wrapper that records every insert, remove and find call into a trace before forwarding it
+    template <class T, class Augmentation = NoAugmentation>
+    class TracedAVLTree
+    {
+        static_assert(std::is_integral<T>::value, "TracedAVLTree records integer keys");
+
+        typedef AVLTree<T, Augmentation> Tree;
+
+        Tree& m_tree;                                // tree the calls are forwarded to
+        OperationTrace& m_trace;                     // trace the calls are recorded in
+
+        public:
+
+        TracedAVLTree(Tree& tree, OperationTrace& trace) : m_tree{tree}, m_trace{trace} {}
+
+        T* insert(const T&);                         // records and forwards insert()
+        T remove(const T&);                          // records and forwards remove(), the call is recorded even if it throws
+        T* find(const T&);                           // records and forwards find()
+
+        Tree& tree() { return m_tree; }              // returns the wrapped tree for calls that are not recorded
+    };
+
+    // adapts a container to replay(), containers with insert, find and erase (like std::set) work as they are
+    template <class Container>
+    struct TraceTarget
+    {
+        template <class T>
+        static void insert(Container& container, const T& key) { container.insert(key); }
+        template <class T>
+        static void remove(Container& container, const T& key) { container.erase(key); }
+        template <class T>
+        static bool find(Container& container, const T& key) { return container.find(key) != container.end(); }
+    };
+
+    template <class T, class Augmentation>
+    struct TraceTarget<AVLTree<T, Augmentation>>
+    {
+        static void insert(AVLTree<T, Augmentation>& tree, const T& key) { tree.insert(key); }
+        static void remove(AVLTree<T, Augmentation>& tree, const T& key)
+        {
+            try { tree.remove(key); }
+            catch(const std::runtime_error&) {}      // the recorded call may have failed the same way, keep replaying
+        }
+        static bool find(AVLTree<T, Augmentation>& tree, const T& key) { return tree.find(key) != nullptr; }
+    };
+
+    struct ReplayResult
+    {
+        std::size_t operations;                      // number of calls replayed
+        std::size_t hits;                            // number of find calls that found their key
+        double seconds;                              // total wall clock time
+        double operationsPerSecond;                  // throughput
+        std::uint64_t p50;                           // latency percentiles in nanoseconds
+        std::uint64_t p90;
+        std::uint64_t p99;
+        std::uint64_t p999;
+        std::uint64_t max;
+    };
+
+    template <class Key, class Container>
+    ReplayResult replay(const OperationTrace&, Container&);  // drives the container with every call in the trace, keys are decoded as Key, timing each call
+
+    template <class T>
+    std::uint64_t OperationTrace::encode(const T& key)                 // encode function start //
+    {
+        static_assert(std::is_integral<T>::value, "OperationTrace only records integer keys");
+
+        std::uint64_t value = static_cast<std::uint64_t>(static_cast<typename std::make_unsigned<T>::type>(key));
+        if(std::is_signed<T>::value)                                   // flip the sign bit so negative keys sort first
+            value ^= std::uint64_t{1} << (8 * sizeof(T) - 1);
+        return value;
+    }                                                                  // encode function end //
+
+    template <class T>
+    T OperationTrace::decode(std::uint64_t value)                      // decode function start //
+    {
+        static_assert(std::is_integral<T>::value, "OperationTrace only records integer keys");
+
+        if(std::is_signed<T>::value)
+            value ^= std::uint64_t{1} << (8 * sizeof(T) - 1);
+        return static_cast<T>(static_cast<typename std::make_unsigned<T>::type>(value));
+    }                                                                  // decode function end //
+
+    inline void OperationTrace::record(TraceOperation operation, std::uint64_t key)  // record function start //
+    {
+        m_records.push_back(TraceRecord{operation, key});
+    }                                                                                // record function end //
+
+    inline void OperationTrace::remapKeys()                            // remapKeys function start //
+    {
+        std::vector<std::uint64_t> keys;
+        keys.reserve(m_records.size());
+
+        for(const TraceRecord& record : m_records)
+            keys.push_back(record.key);
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());  // distinct keys in order, a key's index is its rank
+
+        for(TraceRecord& record : m_records)
+            record.key = static_cast<std::uint64_t>(std::lower_bound(keys.begin(), keys.end(), record.key) - keys.begin());
+    }                                                                  // remapKeys function end //
+
+    inline void OperationTrace::write(std::ostream& out) const         // write function start //
+    {
+        auto writeVarint = [&out](std::uint64_t value)                 // 7 bits per byte, high bit set on every byte but the last
+        {
+            while(value >= 0x80)
+            {
+                out.put(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.put(static_cast<char>(value));
+        };
+
+        writeVarint(s_magic);
+        writeVarint(m_records.size());
+
+        std::uint64_t previous = 0;
+        for(const TraceRecord& record : m_records)
+        {
+            std::uint64_t difference = record.key - previous;          // wraps, zigzag keeps small steps in both directions small
+            std::int64_t signedDifference = static_cast<std::int64_t>(difference);
+            std::uint64_t zigzag = (difference << 1) ^ static_cast<std::uint64_t>(signedDifference >> 63);
+
+            out.put(static_cast<char>(record.operation));
+            writeVarint(zigzag);
+            previous = record.key;
+        }
+
+        if(!out)
+            throw std::runtime_error{
+                "OperationTrace write(), cannot write trace"};
+    }                                                                  // write function end //
+
+    inline OperationTrace OperationTrace::read(std::istream& in)       // read function start //
+    {
+        auto readVarint = [&in]()
+        {
+            std::uint64_t value = 0;
+            for(int shift = 0; shift < 64; shift += 7)
+            {
+                int byte = in.get();
+                if(byte == std::char_traits<char>::eof())
+                    throw std::runtime_error{
+                        "OperationTrace read(), trace is truncated"};
+
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if((byte & 0x80) == 0)
+                    return value;
+            }
+            throw std::runtime_error{
+                "OperationTrace read(), malformed varint"};
+        };
+
+        if(readVarint() != s_magic)
+            throw std::runtime_error{
+                "OperationTrace read(), stream does not hold a trace"};
+
+        OperationTrace trace;
+        std::uint64_t count = readVarint();
+        trace.m_records.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, 1 << 20)));
+
+        std::uint64_t previous = 0;
+        for(std::uint64_t i = 0; i < count; ++i)
+        {
+            int operation = in.get();
+            if(operation < 0 || operation > static_cast<int>(TraceOperation::Find))
+                throw std::runtime_error{
+                    "OperationTrace read(), unknown operation in trace"};
+
+            std::uint64_t zigzag = readVarint();
+            std::uint64_t difference = (zigzag >> 1) ^ (0 - (zigzag & 1));   // undo zigzag, the second term is all ones for odd values
+            previous += difference;
+
+            trace.m_records.push_back(TraceRecord{static_cast<TraceOperation>(operation), previous});
+        }
+
+        return trace;
+    }                                                                  // read function end //
+
+    template <typename T, typename Augmentation>
+    T* TracedAVLTree<T, Augmentation>::insert(const T& value)      // insert function start //
+    {
+        m_trace.record(TraceOperation::Insert, OperationTrace::encode(value));
+        return m_tree.insert(value);
+    }                                                                  // insert function end //
+
+    template <typename T, typename Augmentation>
+    T TracedAVLTree<T, Augmentation>::remove(const T& value)       // remove function start //
+    {
+        m_trace.record(TraceOperation::Remove, OperationTrace::encode(value));
+        return m_tree.remove(value);
+    }                                                                  // remove function end //
+
+    template <typename T, typename Augmentation>
+    T* TracedAVLTree<T, Augmentation>::find(const T& value)        // find function start //
+    {
+        m_trace.record(TraceOperation::Find, OperationTrace::encode(value));
+        return m_tree.find(value);
+    }                                                                  // find function end //
+
+    template <class Key, class Container>
+    ReplayResult replay(const OperationTrace& trace, Container& container)       // replay function start //
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const std::vector<TraceRecord>& records = trace.records();
+        std::vector<std::uint64_t> latencies(records.size());
+        std::size_t hits = 0;
+
+        Clock::time_point start = Clock::now();
+
+        for(std::size_t i = 0; i < records.size(); ++i)
+        {
+            Key key = OperationTrace::decode<Key>(records[i].key);
+            Clock::time_point before = Clock::now();
+
+            switch(records[i].operation)
+            {
+                case TraceOperation::Insert:
+                    TraceTarget<Container>::insert(container, key);
+                    break;
+
+                case TraceOperation::Remove:
+                    TraceTarget<Container>::remove(container, key);
+                    break;
+
+                case TraceOperation::Find:
+                    hits += TraceTarget<Container>::find(container, key);
+                    break;
+            }
+
+            latencies[i] = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before).count());
+        }
+
+        ReplayResult result{};
+        result.operations = records.size();
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.hits = hits;
+
+        if(records.empty())
+            return result;
+
+        result.operationsPerSecond = static_cast<double>(records.size()) / result.seconds;
+
+        auto percentile = [&latencies](double fraction)
+        {
+            std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1));
+            std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index), latencies.end());
+            return latencies[index];
+        };
+
+        result.p50 = percentile(0.5);
+        result.p90 = percentile(0.9);
+        result.p99 = percentile(0.99);
+        result.p999 = percentile(0.999);
+        result.max = *std::max_element(latencies.begin(), latencies.end());
+        return result;
+    }                                                                            // replay function end //
+}
@@ -0,0 +1,740 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DataStructures
+{
+    // owns an open file descriptor and closes it when destroyed
+    class FileHandle
+    {
+        int m_fd;                                    // -1 if no file is open
+
+        public:
+
+        explicit FileHandle(int fd) : m_fd{fd} {}                   // takes ownership of the descriptor
+        FileHandle(const FileHandle&) = delete;                     // copy constructor disabled
+        ~FileHandle() { if(m_fd != -1) close(m_fd); }               // destructor, closes the descriptor
+
+        int get() const { return m_fd; }                            // returns the descriptor
+    };
+
+    // fixed size cache of file pages with clock replacement
+    // a page stays in its frame while it is pinned, dirty pages are written back when evicted or flushed
+    class BufferPool
+    {
+        struct Frame
+        {
+            std::uint64_t page;                      // page held by the frame
+            std::uint32_t pins;                      // callers currently using the frame, never evicted while not zero
+            bool used;                               // false for frames never filled
+            bool dirty;                              // the page was changed since it was read
+            bool referenced;                         // clock bit, set on every pin and cleared as the hand passes
+        };
+
+        int m_fd;                                    // file the pages belong to
+        std::size_t m_pageSize;                      // bytes per page
+        std::vector<unsigned char> m_memory;         // frame i is bytes [i * m_pageSize, (i + 1) * m_pageSize)
+        std::vector<Frame> m_frames;
+        std::unordered_map<std::uint64_t, std::size_t> m_table;    // page to frame
+        std::size_t m_hand;                          // next frame the clock looks at
+
+        std::uint64_t m_hits;                        // pins served from memory
+        std::uint64_t m_faults;                      // pins that read the page from the file
+        std::uint64_t m_writes;                      // pages written back
+
+        public:
+
+        BufferPool(int fd, std::size_t pageSize, std::size_t frames); // caches pages of an open file in the given number of frames
+        BufferPool(const BufferPool&) = delete;                       // copy constructor disabled
+
+        unsigned char* pin(std::uint64_t page, bool fresh = false);    // returns the page's bytes, reading it unless fresh, in which case it starts zeroed, throws if every frame is pinned
+        void unpin(std::uint64_t page, bool dirty);                    // releases a pin, marking the page dirty if it was changed
+        void flush();                                                  // writes every dirty page back
+
+        std::uint64_t hits() const { return m_hits; }                  // returns the number of pins served from memory
+        std::uint64_t faults() const { return m_faults; }              // returns the number of pages read from the file
+        std::uint64_t writes() const { return m_writes; }              // returns the number of pages written to the file
+        std::size_t frames() const { return m_frames.size(); }         // returns the number of frames
+
+        private:
+
+        std::size_t victim();                                          // returns a frame with no pins, writing its page back if dirty
+        void writeBack(std::size_t frame);
+    };
+
+    // AVL tree stored in a file and accessed through a BufferPool, so the tree can be larger than memory
+    // nodes refer to each other by id, page * slots per page + slot + 1, with 0 as the null id
+    // a new node goes into its parent's page while that has room, so small subtrees share pages and a search touches few of them,
+    // otherwise into a freed slot or the most recently started page
+    // page 0 holds the header, the root, size and the list of freed node slots, linked through their left ids, persist across opens
+    template <class T>
+    class PagedAVLTree
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "PagedAVLTree stores raw bytes of T in its file");
+
+        typedef std::uint64_t NodeId;
+
+        struct Node
+        {
+            T value;                                 // must be comparable
+            NodeId left;                             // id of the left child, 0 if none
+            NodeId right;                            // id of the right child, 0 if none
+            std::int32_t height;                     // height of the node in the tree, 0 if leaf node
+        };
+
+        struct Header
+        {
+            std::uint64_t magic;                     // s_magic
+            std::uint64_t valueSize;                 // sizeof(T) of the creator, checked on open
+            std::uint64_t pageSize;                  // bytes per page
+            NodeId root;                             // id of the root node, 0 if the tree is empty
+            std::uint64_t size;                      // number of elements
+            std::uint64_t pages;                     // pages in the file, including the header page
+            NodeId freeList;                         // head of the list of freed node slots
+            std::uint64_t openPage;                  // page new nodes go to when their parent's page is full, 0 if none
+        };
+
+        struct PageHeader
+        {
+            std::uint32_t used;                      // slots handed out from this page so far, slots are never handed out twice from here
+            std::uint32_t reserved;
+        };
+
+        static const std::uint64_t s_magic = 0x44454741504c5641;  // "AVLPAGED"
+
+        FileHandle m_file;                           // declared before m_pool, so the file is closed even if building the pool throws
+        std::size_t m_slotsPerPage;                  // node slots on every page after the header page
+        Header m_header;                             // in memory copy of page 0, written back by flush()
+        mutable BufferPool m_pool;                   // const searches still pin pages, which changes the pool's state but not the tree
+
+        public:
+
+        PagedAVLTree(const std::string& path, std::size_t poolPages, std::size_t pageSize = 4096); // opens the tree file, creating an empty tree if it does not exist
+        PagedAVLTree(const PagedAVLTree<T>&) = delete;                                             // copy constructor disabled
+        ~PagedAVLTree();                                                                           // flushes and closes the file
+
+        bool insert(const T&);                       // insert an element into the tree, returns false if it already exists
+        T remove(const T&);                          // remove an element from the tree, returns the value removed, if it does not exist an exception is thrown
+
+        void buildSorted(const std::vector<T>& sortedValues);          // fills an empty tree with strictly increasing values, every page holds a complete subtree, throws if the tree is not empty
+
+        bool find(const T&, T* result = nullptr) const;                // trys to find an element, if found it is copied into result and true is returned
+
+        template <class Function>
+        void scan(const T& low, const T& high, Function report) const; // calls report(value) for every value in [low, high] in increasing order
+
+        void flush();                                // writes every dirty page and the header to the file
+
+        bool empty() const { return m_header.size == 0; }                              // returns true if the tree is empty
+        std::size_t size() const { return static_cast<std::size_t>(m_header.size); }  // returns the number of elements
+        std::size_t pages() const { return static_cast<std::size_t>(m_header.pages); } // returns the number of pages in the file
+        const BufferPool& pool() const { return m_pool; }                              // returns the buffer pool, for its fault counters
+
+        private:
+
+        static int openFile(const std::string& path); // opens or creates the tree file, throws if it cannot
+
+        Node readNode(NodeId) const;                 // copies a node out of its page
+        void writeNode(NodeId, const Node&);         // copies a node into its page
+
+        NodeId allocate(const Node&, NodeId near);   // stores a new node, on near's page if it has room
+        NodeId takeSlot(std::uint64_t page);         // hands out the page's next never used slot, 0 if the page is full
+        std::uint64_t newPage();                     // appends an empty node page to the file
+
+        NodeId buildNodes(const T* first, const T* last, std::uint64_t page, std::size_t pageLevels, std::int32_t& height);
+                                                     // builds the subtree of the sorted values on the page, subtrees of a multiple of pageLevels levels start a new page
+        void release(NodeId);                        // puts a node slot on the free list
+
+        NodeId insertNode(NodeId, const T&, bool& inserted);           // inserts below the node, returns the new root of its subtree
+        NodeId removeNode(NodeId, const T&, T& removed);               // removes below the node, returns the new root of its subtree
+        NodeId removeMinimum(NodeId, NodeId& minimum);                 // unlinks the smallest node below the node, returns the new root of its subtree
+
+        std::int32_t heightOf(NodeId) const;         // returns the height of the node, -1 for the null id
+        NodeId rebalance(NodeId, Node&);             // updates the height of a node whose children changed, rotating if needed, returns the subtree's root
+        NodeId rotateRight(NodeId, Node&);
+        NodeId rotateLeft(NodeId, Node&);
+    };
+
+    inline BufferPool::BufferPool(int fd, std::size_t pageSize, std::size_t frames) :
+        m_fd{fd}, m_pageSize{pageSize}, m_memory(pageSize * frames), m_frames(frames, Frame{0, 0, false, false, false}),
+        m_table{}, m_hand{0}, m_hits{0}, m_faults{0}, m_writes{0}
+    {                                                                                   // constructor start //
+        if(frames == 0)
+            throw std::runtime_error{
+                "BufferPool BufferPool(), a pool needs at least one frame"};
+    }                                                                                   // constructor end //
+
+    inline unsigned char* BufferPool::pin(std::uint64_t page, bool fresh)              // pin function start //
+    {
+        std::unordered_map<std::uint64_t, std::size_t>::iterator found = m_table.find(page);
+
+        if(found != m_table.end())
+        {
+            Frame& frame = m_frames[found->second];
+            ++frame.pins;
+            frame.referenced = true;
+            ++m_hits;
+            return &m_memory[found->second * m_pageSize];
+        }
+
+        std::size_t index = victim();
+        unsigned char* bytes = &m_memory[index * m_pageSize];
+
+        if(fresh)
+            std::memset(bytes, 0, m_pageSize);
+
+        else
+        {
+            ssize_t read = pread(m_fd, bytes, m_pageSize, static_cast<off_t>(page * m_pageSize));
+            if(read != static_cast<ssize_t>(m_pageSize))
+                throw std::runtime_error{
+                    "BufferPool pin(), cannot read page"};
+            ++m_faults;
+        }
+
+        m_frames[index] = Frame{page, 1, true, fresh, true};                          // a fresh page must reach the file even if never changed
+        m_table[page] = index;
+        return bytes;
+    }                                                                                   // pin function end //
+
+    inline void BufferPool::unpin(std::uint64_t page, bool dirty)                       // unpin function start //
+    {
+        Frame& frame = m_frames[m_table.at(page)];
+        --frame.pins;
+        frame.dirty = frame.dirty || dirty;
+    }                                                                                   // unpin function end //
+
+    inline void BufferPool::flush()                                                     // flush function start //
+    {
+        for(std::size_t i = 0; i < m_frames.size(); ++i)
+            if(m_frames[i].used && m_frames[i].dirty)
+                writeBack(i);
+    }                                                                                   // flush function end //
+
+    inline std::size_t BufferPool::victim()                                             // victim function start //
+    {
+        for(std::size_t step = 0; step < 2 * m_frames.size(); ++step)                  // two sweeps, the first may only clear reference bits
+        {
+            std::size_t index = m_hand;
+            Frame& frame = m_frames[index];
+            m_hand = (m_hand + 1) % m_frames.size();
+
+            if(!frame.used)
+                return index;
+
+            if(frame.pins != 0)
+                continue;
+
+            if(frame.referenced)                                                        // recently used, give it another round
+            {
+                frame.referenced = false;
+                continue;
+            }
+
+            if(frame.dirty)
+                writeBack(index);
+
+            m_table.erase(frame.page);
+            frame.used = false;
+            return index;
+        }
+
+        throw std::runtime_error{
+            "BufferPool victim(), every frame is pinned"};
+    }                                                                                   // victim function end //
+
+    inline void BufferPool::writeBack(std::size_t index)                               // writeBack function start //
+    {
+        Frame& frame = m_frames[index];
+
+        ssize_t written = pwrite(m_fd, &m_memory[index * m_pageSize], m_pageSize, static_cast<off_t>(frame.page * m_pageSize));
+        if(written != static_cast<ssize_t>(m_pageSize))
+            throw std::runtime_error{
+                "BufferPool writeBack(), cannot write page"};
+
+        frame.dirty = false;
+        ++m_writes;
+    }                                                                                   // writeBack function end //
+
+    template <typename T>
+    PagedAVLTree<T>::PagedAVLTree(const std::string& path, std::size_t poolPages, std::size_t pageSize) :
+        m_file{openFile(path)}, m_slotsPerPage{0}, m_header{},
+        m_pool{m_file.get(), pageSize, poolPages}
+    {                                                                                   // constructor start //
+        if(pageSize < sizeof(Header) || pageSize < sizeof(PageHeader) + sizeof(Node))
+            throw std::runtime_error{
+                "PagedAVLTree PagedAVLTree(), page size is too small"};
+
+        m_slotsPerPage = (pageSize - sizeof(PageHeader)) / sizeof(Node);
+
+        struct stat status;
+        if(fstat(m_file.get(), &status) == -1)
+            throw std::runtime_error{
+                "PagedAVLTree PagedAVLTree(), cannot stat " + path};
+
+        if(status.st_size == 0)                                                         // new file, write an empty tree
+        {
+            m_header = Header{s_magic, sizeof(T), pageSize, 0, 0, 1, 0, 0};
+            unsigned char* page = m_pool.pin(0, true);
+            std::memcpy(page, &m_header, sizeof(m_header));
+            m_pool.unpin(0, true);
+            return;
+        }
+
+        ssize_t read = pread(m_file.get(), &m_header, sizeof(m_header), 0);
+
+        if(read != static_cast<ssize_t>(sizeof(m_header)) || m_header.magic != s_magic ||
+           m_header.valueSize != sizeof(T) || m_header.pageSize != pageSize)
+            throw std::runtime_error{
+                "PagedAVLTree PagedAVLTree(), " + path + " is not a tree with this value and page size"};
+    }                                                                                   // constructor end //
+
+    template <typename T>
+    PagedAVLTree<T>::~PagedAVLTree()                                                    // destructor start //
+    {
+        try { flush(); }
+        catch(const std::runtime_error&) {}                                            // nothing sensible to do about a failed write here, m_file closes the file
+    }                                                                                   // destructor end //
+
+    template <typename T>
+    int PagedAVLTree<T>::openFile(const std::string& path)                             // openFile function start //
+    {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if(fd == -1)
+            throw std::runtime_error{
+                "PagedAVLTree PagedAVLTree(), cannot open " + path};
+        return fd;
+    }                                                                                   // openFile function end //
+
+    template <typename T>
+    bool PagedAVLTree<T>::insert(const T& newValue)                                     // insert function start //
+    {
+        bool inserted = false;
+
+        if(m_header.root == 0)                                                          // empty tree condition
+        {
+            m_header.root = allocate(Node{newValue, 0, 0, 0}, 0);
+            inserted = true;
+        }
+        else
+            m_header.root = insertNode(m_header.root, newValue, inserted);
+
+        if(inserted)
+            ++m_header.size;
+        return inserted;
+    }                                                                                   // insert function end //
+
+    template <typename T>
+    T PagedAVLTree<T>::remove(const T& value)                                           // remove function start //
+    {
+        if(!find(value))                                                                // check first so a failed remove changes nothing
+            throw std::runtime_error{
+                "PagedAVLTree remove(), cannot remove value, value does not exist"};
+
+        T removed{};
+        m_header.root = removeNode(m_header.root, value, removed);
+        --m_header.size;
+        return removed;
+    }                                                                                   // remove function end //
+
+    template <typename T>
+    void PagedAVLTree<T>::buildSorted(const std::vector<T>& sortedValues)              // buildSorted function start //
+    {
+        if(m_header.root != 0)
+            throw std::runtime_error{
+                "PagedAVLTree buildSorted(), tree is not empty"};
+
+        for(std::size_t i = 1; i < sortedValues.size(); ++i)
+            if(!(sortedValues[i - 1] < sortedValues[i]))
+                throw std::runtime_error{
+                    "PagedAVLTree buildSorted(), values are not strictly increasing"};
+
+        if(sortedValues.empty())
+            return;
+
+        std::size_t pageLevels = 0;                                                     // levels of a complete subtree that fit on one page
+        while((std::size_t{2} << pageLevels) - 1 <= m_slotsPerPage)
+            ++pageLevels;
+
+        std::int32_t height = 0;
+        m_header.root = buildNodes(sortedValues.data(), sortedValues.data() + sortedValues.size(), 0, pageLevels, height);
+        m_header.size = sortedValues.size();
+        m_header.openPage = 0;                                                          // every page is full or holds the bottom of one subtree, leave them be
+    }                                                                                   // buildSorted function end //
+
+    template <typename T>
+    bool PagedAVLTree<T>::find(const T& value, T* result) const                         // find function start //
+    {
+        NodeId current = m_header.root;
+
+        while(current != 0)
+        {
+            Node node = readNode(current);
+
+            if(value < node.value)
+                current = node.left;
+
+            else if(node.value < value)
+                current = node.right;
+
+            else
+            {
+                if(result != nullptr)
+                    *result = node.value;
+                return true;
+            }
+        }
+
+        return false;
+    }                                                                                   // find function end //
+
+    template <typename T>
+    template <class Function>
+    void PagedAVLTree<T>::scan(const T& low, const T& high, Function report) const      // scan function start //
+    {
+        std::vector<Node> path;                                                         // nodes whose value and right subtree are still to be reported
+        NodeId current = m_header.root;
+
+        while(current != 0)                                                             // path to the first value not less than low
+        {
+            Node node = readNode(current);
+
+            if(node.value < low)
+                current = node.right;
+            else
+            {
+                path.push_back(node);
+                current = node.left;
+            }
+        }
+
+        while(!path.empty())
+        {
+            Node node = path.back();
+            path.pop_back();
+
+            if(high < node.value)
+                return;
+
+            report(node.value);
+
+            for(current = node.right; current != 0;)                                   // the next values are down the left spine of the right subtree
+            {
+                Node next = readNode(current);
+                path.push_back(next);
+                current = next.left;
+            }
+        }
+    }                                                                                   // scan function end //
+
+    template <typename T>
+    void PagedAVLTree<T>::flush()                                                       // flush function start //
+    {
+        unsigned char* page = m_pool.pin(0);
+        std::memcpy(page, &m_header, sizeof(m_header));
+        m_pool.unpin(0, true);
+
+        m_pool.flush();
+
+        if(fsync(m_file.get()) == -1)
+            throw std::runtime_error{
+                "PagedAVLTree flush(), cannot sync file"};
+    }                                                                                   // flush function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::Node PagedAVLTree<T>::readNode(NodeId id) const           // readNode function start //
+    {
+        std::uint64_t page = (id - 1) / m_slotsPerPage + 1;
+        std::size_t slot = static_cast<std::size_t>((id - 1) % m_slotsPerPage);
+
+        Node node;
+        unsigned char* bytes = m_pool.pin(page);
+        std::memcpy(&node, bytes + sizeof(PageHeader) + slot * sizeof(Node), sizeof(Node));
+        m_pool.unpin(page, false);
+        return node;
+    }                                                                                   // readNode function end //
+
+    template <typename T>
+    void PagedAVLTree<T>::writeNode(NodeId id, const Node& node)                        // writeNode function start //
+    {
+        std::uint64_t page = (id - 1) / m_slotsPerPage + 1;
+        std::size_t slot = static_cast<std::size_t>((id - 1) % m_slotsPerPage);
+
+        unsigned char* bytes = m_pool.pin(page);
+        std::memcpy(bytes + sizeof(PageHeader) + slot * sizeof(Node), &node, sizeof(Node));
+        m_pool.unpin(page, true);
+    }                                                                                   // writeNode function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::allocate(const Node& node, NodeId near)
+    {                                                                                   // allocate function start //
+        NodeId id = 0;
+
+        if(near != 0)                                                                   // try the parent's page first
+            id = takeSlot((near - 1) / m_slotsPerPage + 1);
+
+        if(id == 0 && m_header.freeList != 0)                                           // reuse a freed slot
+        {
+            id = m_header.freeList;
+            m_header.freeList = readNode(id).left;
+        }
+
+        if(id == 0 && m_header.openPage != 0)                                           // fill the open page before starting another, a page per lonely node would waste the file
+            id = takeSlot(m_header.openPage);
+
+        if(id == 0)                                                                     // start a new page
+        {
+            m_header.openPage = newPage();
+            id = takeSlot(m_header.openPage);
+        }
+
+        writeNode(id, node);
+        return id;
+    }                                                                                   // allocate function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::takeSlot(std::uint64_t page)
+    {                                                                                   // takeSlot function start //
+        unsigned char* bytes = m_pool.pin(page);
+        PageHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+
+        NodeId id = 0;
+
+        if(header.used < m_slotsPerPage)
+        {
+            id = (page - 1) * m_slotsPerPage + header.used + 1;
+            ++header.used;
+            std::memcpy(bytes, &header, sizeof(header));
+        }
+
+        m_pool.unpin(page, id != 0);
+        return id;
+    }                                                                                   // takeSlot function end //
+
+    template <typename T>
+    std::uint64_t PagedAVLTree<T>::newPage()                                            // newPage function start //
+    {
+        std::uint64_t page = m_header.pages++;
+        m_pool.pin(page, true);                                                         // zeroed, so no slot is used yet
+        m_pool.unpin(page, true);
+        return page;
+    }                                                                                   // newPage function end //
+
+    template <typename T>
+    void PagedAVLTree<T>::release(NodeId id)                                            // release function start //
+    {
+        Node node = Node{};
+        node.left = m_header.freeList;
+        writeNode(id, node);
+        m_header.freeList = id;
+    }                                                                                   // release function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::buildNodes(const T* first, const T* last, std::uint64_t page,
+                                                                 std::size_t pageLevels, std::int32_t& height)
+    {                                                                                   // buildNodes function start //
+        if(first == last)
+        {
+            height = -1;
+            return 0;
+        }
+
+        std::size_t levels = 0;                                                         // levels of this subtree, splitting at the middle makes it as shallow as possible
+        for(std::size_t count = static_cast<std::size_t>(last - first); count != 0; count >>= 1)
+            ++levels;
+
+        if(page == 0 || levels % pageLevels == 0)                                       // counted from the leaves, so the bottom pages are the full ones
+            page = newPage();
+
+        const T* middle = first + (last - first) / 2;
+        NodeId id = takeSlot(page);
+
+        if(id == 0)                                                                     // cannot happen with the level rule, but never write past a page
+            id = takeSlot(page = newPage());
+
+        std::int32_t leftHeight = 0;
+        std::int32_t rightHeight = 0;
+        Node node{*middle, 0, 0, 0};
+        node.left = buildNodes(first, middle, page, pageLevels, leftHeight);
+        node.right = buildNodes(middle + 1, last, page, pageLevels, rightHeight);
+        node.height = std::max(leftHeight, rightHeight) + 1;
+
+        writeNode(id, node);
+        height = node.height;
+        return id;
+    }                                                                                   // buildNodes function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::insertNode(NodeId id, const T& value, bool& inserted)
+    {                                                                                   // insertNode function start //
+        Node node = readNode(id);
+
+        if(value < node.value)
+        {
+            if(node.left == 0)
+            {
+                node.left = allocate(Node{value, 0, 0, 0}, id);
+                inserted = true;
+            }
+            else
+                node.left = insertNode(node.left, value, inserted);
+        }
+
+        else if(node.value < value)
+        {
+            if(node.right == 0)
+            {
+                node.right = allocate(Node{value, 0, 0, 0}, id);
+                inserted = true;
+            }
+            else
+                node.right = insertNode(node.right, value, inserted);
+        }
+
+        if(!inserted)                                                                   // nothing changed below, no need to write anything
+            return id;
+
+        return rebalance(id, node);
+    }                                                                                   // insertNode function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::removeNode(NodeId id, const T& value, T& removed)
+    {                                                                                   // removeNode function start //
+        Node node = readNode(id);                                                       // remove() made sure the value is below this node
+
+        if(value < node.value)
+        {
+            node.left = removeNode(node.left, value, removed);
+            return rebalance(id, node);
+        }
+
+        if(node.value < value)
+        {
+            node.right = removeNode(node.right, value, removed);
+            return rebalance(id, node);
+        }
+
+        removed = node.value;
+
+        if(node.left == 0 || node.right == 0)                                           // at most one child takes the node's place
+        {
+            NodeId child = node.left != 0 ? node.left : node.right;
+            release(id);
+            return child;
+        }
+
+        NodeId successor = 0;                                                           // two children, the smallest node on the right takes the node's place
+        NodeId right = removeMinimum(node.right, successor);
+
+        Node replacement = readNode(successor);
+        replacement.left = node.left;
+        replacement.right = right;
+        release(id);
+
+        return rebalance(successor, replacement);
+    }                                                                                   // removeNode function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::removeMinimum(NodeId id, NodeId& minimum)
+    {                                                                                   // removeMinimum function start //
+        Node node = readNode(id);
+
+        if(node.left == 0)
+        {
+            minimum = id;
+            return node.right;
+        }
+
+        node.left = removeMinimum(node.left, minimum);
+        return rebalance(id, node);
+    }                                                                                   // removeMinimum function end //
+
+    template <typename T>
+    std::int32_t PagedAVLTree<T>::heightOf(NodeId id) const                            // heightOf function start //
+    {
+        if(id == 0)
+            return -1;
+        return readNode(id).height;
+    }                                                                                   // heightOf function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::rebalance(NodeId id, Node& node)
+    {                                                                                   // rebalance function start //
+        std::int32_t leftHeight = heightOf(node.left);
+        std::int32_t rightHeight = heightOf(node.right);
+
+        if(leftHeight - rightHeight > 1)                                               // left heavy
+        {
+            Node left = readNode(node.left);
+
+            if(heightOf(left.right) > heightOf(left.left))                             // left right case
+            {
+                node.left = rotateLeft(node.left, left);
+            }
+
+            return rotateRight(id, node);
+        }
+
+        if(rightHeight - leftHeight > 1)                                               // right heavy
+        {
+            Node right = readNode(node.right);
+
+            if(heightOf(right.left) > heightOf(right.right))                           // right left case
+            {
+                node.right = rotateRight(node.right, right);
+            }
+
+            return rotateLeft(id, node);
+        }
+
+        node.height = std::max(leftHeight, rightHeight) + 1;
+        writeNode(id, node);
+        return id;
+    }                                                                                   // rebalance function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::rotateRight(NodeId id, Node& node)
+    {                                                                                   // rotateRight function start //
+        NodeId top = node.left;
+        Node left = readNode(top);
+
+        node.left = left.right;
+        node.height = std::max(heightOf(node.left), heightOf(node.right)) + 1;
+        writeNode(id, node);
+
+        left.right = id;
+        left.height = std::max(heightOf(left.left), node.height) + 1;
+        writeNode(top, left);
+
+        return top;
+    }                                                                                   // rotateRight function end //
+
+    template <typename T>
+    typename PagedAVLTree<T>::NodeId PagedAVLTree<T>::rotateLeft(NodeId id, Node& node)
+    {                                                                                   // rotateLeft function start //
+        NodeId top = node.right;
+        Node right = readNode(top);
+
+        node.right = right.left;
+        node.height = std::max(heightOf(node.left), heightOf(node.right)) + 1;
+        writeNode(id, node);
+
+        right.left = id;
+        right.height = std::max(node.height, heightOf(right.right)) + 1;
+        writeNode(top, right);
+
+        return top;
+    }                                                                                   // rotateLeft function end //
+}
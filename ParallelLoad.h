@@ -0,0 +1,288 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+#include "TreeImage.h"
+
+namespace DataStructures
+{
+    struct ParallelLoadStats
+    {
+        std::uint64_t values;                        // values loaded
+        std::uint64_t bytes;                         // bytes of values read from the image
+        std::size_t chunks;                          // subtrees built independently
+        std::size_t threads;                         // threads that built them
+        double seconds;                              // from opening the image until the tree was complete
+        double firstQuerySeconds;                    // from opening the image until a find() on the loaded tree returned
+
+        double gigabytesPerSecond() const { return seconds > 0 ? static_cast<double>(bytes) / seconds / 1e9 : 0; } // load throughput
+    };
+
+    // loads a tree image on several threads
+    // the image is a sorted array, so the top levels of the balanced tree over it are a few values at fixed positions and every
+    // subtree below them covers a contiguous range of the file, the loader reads the top values as a skeleton, then threads
+    // take the ranges in turn, read each with one large sequential read, check it is increasing and build its subtree,
+    // finally the subtrees are hung under the skeleton, the tree has exactly the shape AVLTree::buildSorted() would give it
+    template <class T, class Augmentation = NoAugmentation>
+    class ParallelImageLoader
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ParallelImageLoader reads raw bytes of T");
+
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::Node Node;
+
+        struct Chunk                                 // range of the image below the skeleton, built by one thread
+        {
+            std::uint64_t first;                     // index of the first value
+            std::uint64_t last;                      // index past the last value
+            Node* root;                              // built subtree, nullptr until then or if the range is empty
+            Node* largest;                           // its last node in order, linked to whatever follows the chunk when it is stitched
+        };
+
+        public:
+
+        static ParallelLoadStats load(const std::string& path, Tree&, std::size_t threads = 0);         // replaces the tree's contents with the image's values, 0 threads uses one per core
+                                                                                                         // throws if the image is damaged or not increasing, the tree is then left unchanged
+        private:
+
+        static void split(std::uint64_t first, std::uint64_t last, std::size_t depth,
+                          std::vector<std::uint64_t>& skeleton, std::vector<Chunk>& chunks);    // lists the skeleton positions in order and the chunks between them
+
+        static Node* stitch(Tree&, const std::vector<T>& skeletonValues, std::vector<Chunk>& chunks,
+                            std::size_t& nextValue, std::size_t& nextChunk, std::size_t depth, Node* parent,
+                            Node*& previous);                // builds the skeleton in order, hanging the chunks below it and linking every node after previous
+
+        static void deleteNodes(Node*);              // deletes a subtree that never made it into the tree
+
+        static const std::uint64_t s_minChunkValues = 1 << 15; // smaller ranges are not worth a thread
+        static const std::size_t s_chunksPerThread = 4;        // more chunks than threads evens out slow reads
+    };
+
+    template <typename T, typename Augmentation>
+    ParallelLoadStats ParallelImageLoader<T, Augmentation>::load(const std::string& path, Tree& tree, std::size_t threads)
+    {                                                                                           // load function start //
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::ifstream in{path, std::ios::binary};
+        if(!in)
+            throw std::runtime_error{
+                "ParallelImageLoader load(), cannot open " + path};
+
+        std::uint64_t count = readTreeImageHeader<T>(in, path);
+
+        if(threads == 0)
+            threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+        std::size_t depth = 0;                                                                  // skeleton levels, 2^depth chunks
+        while((std::size_t{1} << depth) < threads * s_chunksPerThread && (count >> depth) >= 2 * s_minChunkValues)
+            ++depth;
+
+        std::vector<std::uint64_t> skeleton;
+        std::vector<Chunk> chunks;
+        split(0, count, depth, skeleton, chunks);
+
+        std::vector<T> skeletonValues(skeleton.size());                                         // a few scattered reads, in file order
+        for(std::size_t i = 0; i < skeleton.size(); ++i)
+        {
+            in.seekg(static_cast<std::streamoff>(sizeof(TreeImageHeader) + skeleton[i] * sizeof(T)));
+            in.read(reinterpret_cast<char*>(&skeletonValues[i]), sizeof(T));
+        }
+
+        if(!in)
+            throw std::runtime_error{
+                "ParallelImageLoader load(), " + path + " is truncated"};
+
+        for(std::size_t i = 1; i < skeletonValues.size(); ++i)
+            if(!(skeletonValues[i - 1] < skeletonValues[i]))
+                throw std::runtime_error{
+                    "ParallelImageLoader load(), values are not strictly increasing"};
+
+        std::atomic<std::size_t> nextTask{0};
+        std::vector<std::exception_ptr> failures(std::min(threads, chunks.size()));
+
+        auto work = [&](std::size_t worker)
+        {
+            try
+            {
+                std::ifstream chunkIn{path, std::ios::binary};
+                std::vector<T> values;
+
+                for(std::size_t i = nextTask++; i < chunks.size(); i = nextTask++)
+                {
+                    Chunk& chunk = chunks[i];
+                    if(chunk.first == chunk.last)
+                        continue;
+
+                    values.resize(static_cast<std::size_t>(chunk.last - chunk.first));
+                    chunkIn.seekg(static_cast<std::streamoff>(sizeof(TreeImageHeader) + chunk.first * sizeof(T)));
+                    chunkIn.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+
+                    if(!chunkIn)
+                        throw std::runtime_error{
+                            "ParallelImageLoader load(), " + path + " is truncated"};
+
+                    for(std::size_t j = 1; j < values.size(); ++j)
+                        if(!(values[j - 1] < values[j]))
+                            throw std::runtime_error{
+                                "ParallelImageLoader load(), values are not strictly increasing"};
+
+                    if((i != 0 && !(skeletonValues[i - 1] < values.front())) ||                  // chunk i lies between skeleton values i - 1 and i
+                       (i < skeletonValues.size() && !(values.back() < skeletonValues[i])))
+                        throw std::runtime_error{
+                            "ParallelImageLoader load(), values are not strictly increasing"};
+
+                    chunk.largest = nullptr;
+                    chunk.root = tree.buildNodes(values.data(), values.data() + values.size(), nullptr, chunk.largest);
+                }
+            }
+            catch(...)
+            {
+                failures[worker] = std::current_exception();
+                nextTask = chunks.size();                                                       // the others stop after their current chunk
+            }
+        };
+
+        std::vector<std::thread> workers;
+        try
+        {
+            for(std::size_t worker = 1; worker < failures.size(); ++worker)
+                workers.emplace_back(work, worker);
+        }
+        catch(...)                                                                              // a thread could not start, the running ones still use the locals above
+        {
+            nextTask = chunks.size();
+            for(std::thread& worker : workers)
+                worker.join();
+
+            for(Chunk& chunk : chunks)
+                deleteNodes(chunk.root);
+            throw;
+        }
+
+        work(0);                                                                                // the calling thread takes chunks too
+
+        for(std::thread& worker : workers)
+            worker.join();
+
+        for(const std::exception_ptr& failure : failures)
+            if(failure)
+            {
+                for(Chunk& chunk : chunks)
+                    deleteNodes(chunk.root);
+                std::rethrow_exception(failure);
+            }
+
+        tree.clear();
+
+        std::size_t nextValue = 0;
+        std::size_t nextChunk = 0;
+        Node* previous = nullptr;
+        tree.m_root = stitch(tree, skeletonValues, chunks, nextValue, nextChunk, depth, nullptr, previous);
+        tree.m_size = static_cast<std::size_t>(count);
+
+        ParallelLoadStats stats{count, count * sizeof(T), chunks.size(), workers.size() + 1, 0, 0};
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const Tree& loaded = tree;                                                              // the const find(), a probe must not count as an adaptive access
+        if(!skeletonValues.empty())
+            loaded.find(skeletonValues[skeletonValues.size() / 2]);
+        else if(loaded.root() != nullptr)
+            loaded.find(*loaded.root());
+        stats.firstQuerySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return stats;
+    }                                                                                           // load function end //
+
+    template <typename T, typename Augmentation>
+    void ParallelImageLoader<T, Augmentation>::split(std::uint64_t first, std::uint64_t last, std::size_t depth,
+                                       std::vector<std::uint64_t>& skeleton, std::vector<Chunk>& chunks)
+    {                                                                                           // split function start //
+        if(depth == 0)
+        {
+            chunks.push_back(Chunk{first, last, nullptr, nullptr});
+            return;
+        }
+
+        std::uint64_t middle = first + (last - first) / 2;                                      // same middle as AVLTree::buildNodes()
+
+        split(first, middle, depth - 1, skeleton, chunks);
+        skeleton.push_back(middle);
+        split(middle + 1, last, depth - 1, skeleton, chunks);
+    }                                                                                           // split function end //
+
+    template <typename T, typename Augmentation>
+    typename ParallelImageLoader<T, Augmentation>::Node* ParallelImageLoader<T, Augmentation>::stitch(Tree& tree, const std::vector<T>& skeletonValues,
+        std::vector<Chunk>& chunks, std::size_t& nextValue, std::size_t& nextChunk, std::size_t depth, Node* parent, Node*& previous)
+    {                                                                                           // stitch function start //
+        if(depth == 0)
+        {
+            Chunk& chunk = chunks[nextChunk++];
+            if(chunk.root == nullptr)
+                return nullptr;
+
+            chunk.root->parent = parent;
+
+            if constexpr(Augmentation::threaded)
+            {
+                Node* smallest = chunk.root;                                                    // the chunk is linked inside, only its ends need joining
+                while(smallest->left != nullptr)
+                    smallest = smallest->left;
+
+                if(previous != nullptr)
+                    previous->next = smallest;
+            }
+            previous = chunk.largest;
+
+            return chunk.root;
+        }
+
+        Node* left = stitch(tree, skeletonValues, chunks, nextValue, nextChunk, depth - 1, nullptr, previous);   // in order, like split() listed them
+        Node* node = new Node{skeletonValues[nextValue++], parent, left};
+        if(left != nullptr)
+            left->parent = node;
+
+        if constexpr(Augmentation::threaded)
+            if(previous != nullptr)
+                previous->next = node;
+        previous = node;
+
+        node->right = stitch(tree, skeletonValues, chunks, nextValue, nextChunk, depth - 1, node, previous);
+        tree.update(node);
+
+        return node;
+    }                                                                                           // stitch function end //
+
+    template <typename T, typename Augmentation>
+    void ParallelImageLoader<T, Augmentation>::deleteNodes(Node* node)                      // deleteNodes function start //
+    {
+        if(node == nullptr)
+            return;
+
+        std::vector<Node*> stack{node};
+
+        while(!stack.empty())
+        {
+            Node* current = stack.back();
+            stack.pop_back();
+
+            if(current->left != nullptr)
+                stack.push_back(current->left);
+
+            if(current->right != nullptr)
+                stack.push_back(current->right);
+
+            delete current;
+        }
+    }                                                                                           // deleteNodes function end //
+}
@@ -0,0 +1,214 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace DataStructures
+{
+    // hardware performance counters around a benchmark phase, e.g. inserting, finding, removing or scanning an AVLTree
+    // every counter is opened on its own, so a counter the kernel or container refuses is just reported as unavailable
+    // on systems without perf_event_open every counter is unavailable and measure() only runs the phase
+    class PerfCounters
+    {
+        public:
+
+        enum Counter
+        {
+            Cycles,
+            Instructions,
+            L1DataMisses,
+            LastLevelCacheMisses,
+            DataTLBMisses,
+            BranchMisses,
+            CounterCount
+        };
+
+        struct Reading
+        {
+            std::uint64_t values[CounterCount];      // counts for the measured phase, scaled up if the kernel multiplexed the counter
+            bool available[CounterCount];            // false if the counter could not be opened or never ran
+            std::uint64_t operations;                // number of operations the phase performed
+
+            double perOperation(Counter) const;      // returns the count divided by the operations, 0 if unavailable
+        };
+
+        PerfCounters();                              // constructor, opens every counter for the calling thread
+        PerfCounters(const PerfCounters&) = delete;  // copy constructor disabled
+        ~PerfCounters();                             // destructor, closes the counters
+
+        bool available() const;                      // returns true if at least one counter could be opened
+        bool available(Counter) const;               // returns true if the given counter could be opened
+
+        void start();                                // resets and enables the counters
+        Reading stop(std::uint64_t operations);      // disables the counters and reads them
+
+        template <class Function>
+        Reading measure(std::uint64_t operations, Function phase); // runs phase between start() and stop()
+
+        static const char* name(Counter);            // returns a printable name for the counter
+        static void report(std::ostream&, const char* phase, const Reading&); // prints one line of per operation counts, unavailable counters print as n/a
+
+        private:
+
+        int m_descriptors[CounterCount];             // perf event file descriptors, -1 if the counter is unavailable
+    };
+
+    inline double PerfCounters::Reading::perOperation(Counter counter) const  // perOperation function start //
+    {
+        if(!available[counter] || operations == 0)
+            return 0.0;
+        return static_cast<double>(values[counter]) / static_cast<double>(operations);
+    }                                                                          // perOperation function end //
+
+    inline PerfCounters::PerfCounters()                                        // constructor start //
+    {
+        for(int i = 0; i < CounterCount; ++i)
+            m_descriptors[i] = -1;
+
+#if defined(__linux__)
+        const std::uint64_t cacheMiss = static_cast<std::uint64_t>(PERF_COUNT_HW_CACHE_OP_READ) << 8
+                                      | static_cast<std::uint64_t>(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16;
+
+        const std::uint32_t types[CounterCount] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+
+        const std::uint64_t configs[CounterCount] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | cacheMiss,
+            PERF_COUNT_HW_CACHE_LL | cacheMiss,
+            PERF_COUNT_HW_CACHE_DTLB | cacheMiss,
+            PERF_COUNT_HW_BRANCH_MISSES};
+
+        for(int i = 0; i < CounterCount; ++i)
+        {
+            perf_event_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.type = types[i];
+            attributes.config = configs[i];
+            attributes.disabled = 1;                                           // enabled by start()
+            attributes.exclude_kernel = 1;                                     // user space only, allowed at perf_event_paranoid 2
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            long descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0); // this thread, any cpu, no group
+            m_descriptors[i] = static_cast<int>(descriptor);                   // -1 if refused, e.g. inside a container without CAP_PERFMON
+        }
+#endif
+    }                                                                          // constructor end //
+
+    inline PerfCounters::~PerfCounters()                                       // destructor start //
+    {
+#if defined(__linux__)
+        for(int i = 0; i < CounterCount; ++i)
+            if(m_descriptors[i] != -1)
+                close(m_descriptors[i]);
+#endif
+    }                                                                          // destructor end //
+
+    inline bool PerfCounters::available() const                                // available function start //
+    {
+        for(int i = 0; i < CounterCount; ++i)
+            if(m_descriptors[i] != -1)
+                return true;
+        return false;
+    }                                                                          // available function end //
+
+    inline bool PerfCounters::available(Counter counter) const                 // available counter function start //
+    {
+        return m_descriptors[counter] != -1;
+    }                                                                          // available counter function end //
+
+    inline void PerfCounters::start()                                          // start function start //
+    {
+#if defined(__linux__)
+        for(int i = 0; i < CounterCount; ++i)
+        {
+            if(m_descriptors[i] == -1)
+                continue;
+
+            ioctl(m_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }                                                                          // start function end //
+
+    inline PerfCounters::Reading PerfCounters::stop(std::uint64_t operations)  // stop function start //
+    {
+        Reading reading;
+        reading.operations = operations;
+
+        for(int i = 0; i < CounterCount; ++i)
+        {
+            reading.values[i] = 0;
+            reading.available[i] = false;
+        }
+
+#if defined(__linux__)
+        for(int i = 0; i < CounterCount; ++i)                                  // disable everything first so reading does not count itself
+            if(m_descriptors[i] != -1)
+                ioctl(m_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        for(int i = 0; i < CounterCount; ++i)
+        {
+            if(m_descriptors[i] == -1)
+                continue;
+
+            std::uint64_t buffer[3];                                           // value, time enabled, time running
+            if(read(m_descriptors[i], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)))
+                continue;
+
+            if(buffer[2] == 0)                                                 // the counter was never scheduled on the pmu
+                continue;
+
+            double scale = static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]);
+            reading.values[i] = static_cast<std::uint64_t>(static_cast<double>(buffer[0]) * scale);
+            reading.available[i] = true;
+        }
+#endif
+
+        return reading;
+    }                                                                          // stop function end //
+
+    template <class Function>
+    PerfCounters::Reading PerfCounters::measure(std::uint64_t operations, Function phase)
+    {                                                                          // measure function start //
+        start();
+        phase();
+        return stop(operations);
+    }                                                                          // measure function end //
+
+    inline const char* PerfCounters::name(Counter counter)                     // name function start //
+    {
+        static const char* const names[CounterCount] = {
+            "cycles", "instructions", "L1d-misses", "LLC-misses", "dTLB-misses", "branch-misses"};
+        return names[counter];
+    }                                                                          // name function end //
+
+    inline void PerfCounters::report(std::ostream& out, const char* phase, const Reading& reading)
+    {                                                                          // report function start //
+        out << phase << " (" << reading.operations << " ops, per op):";
+
+        for(int i = 0; i < CounterCount; ++i)
+        {
+            Counter counter = static_cast<Counter>(i);
+            out << ' ' << name(counter) << '=';
+
+            if(reading.available[i])
+                out << reading.perOperation(counter);
+            else
+                out << "n/a";
+        }
+
+        out << '\n';
+    }                                                                          // report function end //
+}
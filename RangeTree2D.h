@@ -0,0 +1,278 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace DataStructures
+{
+    // two dimensional range tree answering box queries over (x, y) points
+    // the primary tree splits the points by x at the median, so it is perfectly balanced and every node holds its points sorted by y
+    // fractional cascading: a node remembers for every position of its y order how many of the points before it went to the left child,
+    // so the y range found by one binary search at the root is carried down to every node in O(1)
+    // inserts use the logarithmic method, the points are kept in static trees of 1, 2, 4, ... points and equal sized trees are merged
+    template <class X, class Y>
+    class RangeTree2D
+    {
+        public:
+
+        struct Point
+        {
+            X x;
+            Y y;
+        };
+
+        private:
+
+        class Layer                                  // static range tree over a fixed set of points
+        {
+            struct Entry
+            {
+                Y y;                                 // y of the point
+                std::uint32_t index;                 // position of the point in x order
+            };
+
+            std::vector<Point> m_points;             // points sorted by x, a node covers a contiguous range of them
+            std::vector<std::vector<Entry>> m_levels;               // for every depth, each node's points sorted by y, stored at the node's x range
+            std::vector<std::vector<std::uint32_t>> m_leftCounts;   // for every depth and position, how many points before it in its node go left
+
+            std::size_t leftCount(std::size_t level, std::size_t low, std::size_t high, std::size_t position) const;
+
+            template <class Function>
+            void query(std::size_t level, std::size_t low, std::size_t high, std::size_t first, std::size_t last,
+                       std::size_t xFirst, std::size_t xLast, const Y& yHigh, Function& report) const;
+
+            std::size_t count(std::size_t level, std::size_t low, std::size_t high, std::size_t first, std::size_t last,
+                              std::size_t xFirst, std::size_t xLast) const;
+
+            public:
+
+            explicit Layer(std::vector<Point> points);  // builds the tree, points are sorted by x here
+
+            const std::vector<Point>& points() const { return m_points; }
+            bool empty() const { return m_points.empty(); }
+
+            template <class Function>
+            void query(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh, Function& report) const;
+            std::size_t count(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh) const;
+        };
+
+        std::vector<Layer> m_layers;                 // m_layers[i] holds 2^i points or none
+        std::size_t m_size;                          // number of points
+
+        public:
+
+        RangeTree2D();                                      // constructor
+        explicit RangeTree2D(const std::vector<Point>&);    // builds a single static tree over the points
+
+        void insert(const X&, const Y&);                    // inserts a point, amortized O(log^2 n)
+
+        template <class Function>
+        void query(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh, Function report) const; // calls report(x, y) for every point in the closed box
+        std::size_t count(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh) const;           // counts the points in the closed box without visiting them
+
+        bool empty() const { return m_size == 0; }          // returns true if there are no points
+        std::size_t size() const { return m_size; }         // returns the number of points
+    };
+
+    template <typename X, typename Y>
+    RangeTree2D<X, Y>::RangeTree2D() : m_layers{}, m_size{0}                            // constructor start //
+    {}                                                                                  // constructor end //
+
+    template <typename X, typename Y>
+    RangeTree2D<X, Y>::RangeTree2D(const std::vector<Point>& points) : m_layers{}, m_size{points.size()}
+    {                                                                                   // bulk constructor start //
+        if(!points.empty())
+            m_layers.emplace_back(points);
+    }                                                                                   // bulk constructor end //
+
+    template <typename X, typename Y>
+    void RangeTree2D<X, Y>::insert(const X& x, const Y& y)                              // insert function start //
+    {
+        std::vector<Point> carry{Point{x, y}};
+
+        for(std::size_t i = 0; ; ++i)                                                   // like adding 1 to a binary counter
+        {
+            if(i == m_layers.size())
+            {
+                m_layers.emplace_back(std::move(carry));
+                break;
+            }
+
+            if(m_layers[i].empty())                                                     // free slot, the carried points stop here
+            {
+                m_layers[i] = Layer{std::move(carry)};
+                break;
+            }
+
+            const std::vector<Point>& points = m_layers[i].points();                    // slot taken, merge its points into the carry
+            carry.insert(carry.end(), points.begin(), points.end());
+            m_layers[i] = Layer{std::vector<Point>{}};
+        }
+
+        ++m_size;
+    }                                                                                   // insert function end //
+
+    template <typename X, typename Y>
+    template <class Function>
+    void RangeTree2D<X, Y>::query(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh, Function report) const
+    {                                                                                   // query function start //
+        for(const Layer& layer : m_layers)
+            if(!layer.empty())
+                layer.query(xLow, xHigh, yLow, yHigh, report);
+    }                                                                                   // query function end //
+
+    template <typename X, typename Y>
+    std::size_t RangeTree2D<X, Y>::count(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh) const
+    {                                                                                   // count function start //
+        std::size_t total = 0;
+        for(const Layer& layer : m_layers)
+            if(!layer.empty())
+                total += layer.count(xLow, xHigh, yLow, yHigh);
+        return total;
+    }                                                                                   // count function end //
+
+    template <typename X, typename Y>
+    RangeTree2D<X, Y>::Layer::Layer(std::vector<Point> points) : m_points{std::move(points)}
+    {                                                                                   // layer constructor start //
+        std::sort(m_points.begin(), m_points.end(), [](const Point& a, const Point& b) { return a.x < b.x; });
+
+        std::size_t count = m_points.size();
+        if(count == 0)
+            return;
+
+        std::vector<Entry> top(count);
+        for(std::size_t i = 0; i < count; ++i)
+            top[i] = Entry{m_points[i].y, static_cast<std::uint32_t>(i)};
+
+        std::stable_sort(top.begin(), top.end(), [](const Entry& a, const Entry& b) { return a.y < b.y; });
+        m_levels.push_back(std::move(top));
+
+        std::vector<std::pair<std::size_t, std::size_t>> nodes;                         // nodes of the deepest level that still have to be split
+        if(count > 1)
+            nodes.emplace_back(0, count);
+
+        while(!nodes.empty())
+        {
+            const std::vector<Entry>& level = m_levels.back();
+            std::vector<Entry> next(count);                                             // positions of leaves above this level are never read
+            std::vector<std::uint32_t> leftCounts(count);
+            std::vector<std::pair<std::size_t, std::size_t>> children;
+
+            for(const std::pair<std::size_t, std::size_t>& node : nodes)
+            {
+                std::size_t low = node.first;
+                std::size_t high = node.second;
+                std::size_t middle = (low + high) / 2;
+                std::size_t left = low;                                                 // stable partition keeps both halves sorted by y
+                std::size_t right = middle;
+
+                for(std::size_t i = low; i < high; ++i)
+                {
+                    leftCounts[i] = static_cast<std::uint32_t>(left - low);
+
+                    if(level[i].index < middle)
+                        next[left++] = level[i];
+                    else
+                        next[right++] = level[i];
+                }
+
+                if(middle - low > 1)                                                    // single points are leaves, a query never goes below them
+                    children.emplace_back(low, middle);
+                if(high - middle > 1)
+                    children.emplace_back(middle, high);
+            }
+
+            m_leftCounts.push_back(std::move(leftCounts));
+            m_levels.push_back(std::move(next));
+            nodes.swap(children);
+        }
+    }                                                                                   // layer constructor end //
+
+    template <typename X, typename Y>
+    std::size_t RangeTree2D<X, Y>::Layer::leftCount(std::size_t level, std::size_t low, std::size_t high, std::size_t position) const
+    {                                                                                   // leftCount function start //
+        if(position == high - low)                                                      // past the last point, everything left of the middle went left
+            return (high - low) / 2;
+        return m_leftCounts[level][low + position];
+    }                                                                                   // leftCount function end //
+
+    template <typename X, typename Y>
+    template <class Function>
+    void RangeTree2D<X, Y>::Layer::query(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh, Function& report) const
+    {                                                                                   // layer query function start //
+        auto byX = [](const Point& point, const X& x) { return point.x < x; };
+        auto byY = [](const Entry& entry, const Y& y) { return entry.y < y; };
+
+        std::size_t xFirst = std::lower_bound(m_points.begin(), m_points.end(), xLow, byX) - m_points.begin();
+        std::size_t xLast = std::upper_bound(m_points.begin(), m_points.end(), xHigh, [](const X& x, const Point& point) { return x < point.x; }) - m_points.begin();
+        std::size_t first = std::lower_bound(m_levels[0].begin(), m_levels[0].end(), yLow, byY) - m_levels[0].begin(); // the only binary search on y, yHigh is checked while reporting
+
+        if(xFirst >= xLast)
+            return;
+
+        query(0, 0, m_points.size(), first, m_points.size(), xFirst, xLast, yHigh, report);
+    }                                                                                   // layer query function end //
+
+    template <typename X, typename Y>
+    template <class Function>
+    void RangeTree2D<X, Y>::Layer::query(std::size_t level, std::size_t low, std::size_t high, std::size_t first, std::size_t last,
+                                         std::size_t xFirst, std::size_t xLast, const Y& yHigh, Function& report) const
+    {                                                                                   // layer node query function start //
+        if(first >= last || high <= xFirst || low >= xLast)                             // no points of this node are in the box
+            return;
+
+        if(xFirst <= low && high <= xLast)                                              // whole node is inside the x range, report by y order
+        {
+            for(std::size_t i = low + first; i < low + last && !(yHigh < m_levels[level][i].y); ++i)
+            {
+                const Point& point = m_points[m_levels[level][i].index];
+                report(point.x, point.y);
+            }
+            return;
+        }
+
+        std::size_t middle = (low + high) / 2;
+        std::size_t leftFirst = leftCount(level, low, high, first);                     // carry the y range down to both children
+        std::size_t leftLast = leftCount(level, low, high, last);
+
+        query(level + 1, low, middle, leftFirst, leftLast, xFirst, xLast, yHigh, report);
+        query(level + 1, middle, high, first - leftFirst, last - leftLast, xFirst, xLast, yHigh, report);
+    }                                                                                   // layer node query function end //
+
+    template <typename X, typename Y>
+    std::size_t RangeTree2D<X, Y>::Layer::count(const X& xLow, const X& xHigh, const Y& yLow, const Y& yHigh) const
+    {                                                                                   // layer count function start //
+        auto byX = [](const Point& point, const X& x) { return point.x < x; };
+        auto byY = [](const Entry& entry, const Y& y) { return entry.y < y; };
+
+        std::size_t xFirst = std::lower_bound(m_points.begin(), m_points.end(), xLow, byX) - m_points.begin();
+        std::size_t xLast = std::upper_bound(m_points.begin(), m_points.end(), xHigh, [](const X& x, const Point& point) { return x < point.x; }) - m_points.begin();
+        std::size_t first = std::lower_bound(m_levels[0].begin(), m_levels[0].end(), yLow, byY) - m_levels[0].begin();
+        std::size_t last = std::upper_bound(m_levels[0].begin(), m_levels[0].end(), yHigh, [](const Y& y, const Entry& entry) { return y < entry.y; }) - m_levels[0].begin();
+
+        if(xFirst >= xLast)
+            return 0;
+
+        return count(0, 0, m_points.size(), first, last, xFirst, xLast);
+    }                                                                                   // layer count function end //
+
+    template <typename X, typename Y>
+    std::size_t RangeTree2D<X, Y>::Layer::count(std::size_t level, std::size_t low, std::size_t high, std::size_t first, std::size_t last,
+                                                std::size_t xFirst, std::size_t xLast) const
+    {                                                                                   // layer node count function start //
+        if(first >= last || high <= xFirst || low >= xLast)
+            return 0;
+
+        if(xFirst <= low && high <= xLast)                                              // both ends of the y range are known here, no visiting needed
+            return last - first;
+
+        std::size_t middle = (low + high) / 2;
+        std::size_t leftFirst = leftCount(level, low, high, first);
+        std::size_t leftLast = leftCount(level, low, high, last);
+
+        return count(level + 1, low, middle, leftFirst, leftLast, xFirst, xLast)
+             + count(level + 1, middle, high, first - leftFirst, last - leftLast, xFirst, xLast);
+    }                                                                                   // layer node count function end //
+}
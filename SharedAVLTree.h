@@ -0,0 +1,611 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stack>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DataStructures
+{
+    // AVL tree stored in a POSIX shared memory segment
+    // one writer process creates the segment and mutates the tree, any number of reader processes map it read only
+    // nodes refer to each other by their byte offset from the start of the segment, so every process can map it at a different address
+    // readers never lock, a sequence counter (seqlock) is bumped before and after every mutation and readers retry if it changed under them,
+    // backing off to yielding the processor and giving up with an exception if the writer never finishes, for instance because it died mid mutation
+    // this is a separate class rather than a storage mode of AVLTree, AVLTree's balancing code works on Node* links and its nodes carry
+    // process local state (next links, counters, checkpoint references), so the insert, remove and rotation code is repeated here over offsets
+    template <class T>
+    class SharedAVLTree
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SharedAVLTree values are shared byte for byte between processes");
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "SharedAVLTree needs address free atomics");
+
+        typedef std::uint64_t Offset;   // byte offset of a node from the start of the segment, 0 is used as the null offset
+
+        struct Node
+        {
+            T value;                    // must be comparable
+            Offset parent;              // offset of parent, 0 if root node
+            Offset left;                // offset of left child, 0 if leaf node
+            Offset right;               // offset of right child, 0 if leaf node
+
+            std::int32_t height;        // height of the node in the tree, 0 if leaf node
+            std::int32_t balanceFactor; // balance factor of current node, will be in the range -2 - 2
+        };
+
+        struct Header
+        {
+            std::uint64_t magic;                 // identifies an initialized segment
+            std::uint64_t valueSize;             // sizeof(T) of the writer, checked by readers
+            std::uint64_t bytes;                 // size of the whole segment in bytes
+            std::atomic<std::uint64_t> sequence; // seqlock counter, odd while the writer is mutating the tree
+            std::atomic<Offset> root;            // offset of the root node, 0 if the tree is empty
+            std::atomic<std::uint64_t> size;     // number of elements in the tree
+            Offset freeList;                     // head of the list of removed nodes, linked through their left offsets, writer only
+            Offset next;                         // offset of the first never used node slot, writer only
+        };
+
+        static const std::uint64_t s_magic = 0x41564c5348415245; // "AVLSHARE"
+        static const int s_maxDepth = 128;                        // readers give up on a path longer than any valid AVL tree can have and retry
+        static const std::size_t s_spinRetries = 64;              // retries before a reader starts yielding the processor to the writer
+        static const std::size_t s_yieldRetries = 1024;           // retries before a reader starts sleeping between attempts
+        static const std::size_t s_maxRetries = 1 << 14;          // retries before a reader decides the writer is stuck and throws, about a second of sleeps
+
+        std::string m_name;        // name of the shared memory object
+        unsigned char* m_base;     // start of this process's mapping of the segment
+        std::size_t m_length;      // length of the mapping in bytes
+        Header* m_header;          // header at the start of the segment
+        bool m_writer;             // true if this process created the segment and may mutate it
+
+        public:
+
+        SharedAVLTree(const std::string& name, std::size_t bytes);    // creates a new segment of the given size in bytes and opens it for writing, throws if it already exists
+        explicit SharedAVLTree(const std::string& name);               // maps an existing segment read only
+        SharedAVLTree(const SharedAVLTree<T>&) = delete;               // copy constructor disabled
+        ~SharedAVLTree();                                              // destructor, unmaps the segment but leaves it in place for other processes
+
+        static void unlink(const std::string& name);    // removes the named segment, processes that still have it mapped keep their mapping
+
+        T* insert(const T&);                            // insert an element into the tree, returns a pointer to an element if it already exists, otherwise returns nullptr, writer only
+        T remove(const T&);                             // remove an element from the tree, returns the value removed, if it does not exist an exception is thrown, writer only
+
+        bool find(const T&, T* result = nullptr) const; // trys to find an element given a value, if found it is copied into result and true is returned
+                                                        // throws if the writer stays mid mutation for s_maxRetries attempts
+
+        bool empty() const;                             // returns true if the tree is empty, false if not
+        std::size_t size() const;                       // returns the size of the tree
+        std::uint64_t version() const;                  // returns the sequence counter, it changes every time the writer mutates the tree
+        std::size_t capacity() const;                   // returns the maximum number of nodes the segment can hold, not its size in bytes
+
+        private:
+
+        Node* node(Offset) const;                       // converts an offset to a node pointer, 0 becomes nullptr
+        Offset offset(const Node*) const;               // converts a node pointer to its offset, nullptr becomes 0
+        bool validOffset(Offset) const;                 // true if the offset points at a node slot inside the mapping, used by readers which may see torn offsets
+
+        static Offset firstSlot();                      // offset of the first node slot, right after the header
+
+        void beginWrite();                              // makes the sequence counter odd, readers will retry until endWrite()
+        void endWrite();                                // makes the sequence counter even again
+        static void backoff(std::size_t attempt);       // waits before a reader's next attempt, longer as attempts fail
+
+        Node* allocate(const T&);                       // takes a node slot from the free list or the unused tail of the segment
+        void release(Node*);                            // puts a node slot on the free list
+
+        std::stack<Node*> stackNodes(const T& value);   // trys to find matching node given a value, but every node that is iterated through is added to a stack
+                                                        // if no matching node is found the top most element would be nullptr
+        void unstackNodes(std::stack<Node*>&);          // unstacks the given stack of node pointers, updating and balancing each node as it is unstacked
+
+        void update(Node*);                             // updates the given nodes height and balance factor
+        void balance(Node*);                            // balances the given node
+
+        void rightRotation(Node*);                      // does a right rotation on a given node
+        void leftRotation(Node*);                       // does a left rotation on a given node
+
+        void replaceChild(Node* parent, Node* oldChild, Node* newChild); // makes newChild take oldChild's place under parent, or the root's place if parent is nullptr
+    };
+
+    template <typename T>
+    SharedAVLTree<T>::SharedAVLTree(const std::string& name, std::size_t bytes) :       // creating constructor start //
+        m_name{name}, m_base{nullptr}, m_length{bytes}, m_header{nullptr}, m_writer{true}
+    {
+        if(bytes < firstSlot() + sizeof(Node))                                          // the segment has to fit the header and at least one node
+            throw std::runtime_error{
+                "SharedAVLTree(), segment size is too small to hold any nodes"};
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if(fd == -1)
+            throw std::runtime_error{
+                "SharedAVLTree(), cannot create shared memory object " + name};
+
+        if(ftruncate(fd, static_cast<off_t>(bytes)) == -1)                              // size the segment, new pages read as zero
+        {
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error{
+                "SharedAVLTree(), cannot size shared memory object " + name};
+        }
+
+        void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);                                                                      // the mapping keeps the object alive
+
+        if(mapping == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            throw std::runtime_error{
+                "SharedAVLTree(), cannot map shared memory object " + name};
+        }
+
+        m_base = static_cast<unsigned char*>(mapping);
+        m_header = new (m_base) Header;                                                 // construct the header in place
+        m_header->valueSize = sizeof(T);
+        m_header->bytes = bytes;
+        m_header->sequence.store(0, std::memory_order_relaxed);
+        m_header->root.store(0, std::memory_order_relaxed);
+        m_header->size.store(0, std::memory_order_relaxed);
+        m_header->freeList = 0;
+        m_header->next = firstSlot();
+
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = s_magic;                                                      // written last, readers reject the segment until it is set
+    }                                                                                   // creating constructor end //
+
+    template <typename T>
+    SharedAVLTree<T>::SharedAVLTree(const std::string& name) :                          // opening constructor start //
+        m_name{name}, m_base{nullptr}, m_length{0}, m_header{nullptr}, m_writer{false}
+    {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if(fd == -1)
+            throw std::runtime_error{
+                "SharedAVLTree(), cannot open shared memory object " + name};
+
+        struct stat status;
+        if(fstat(fd, &status) == -1 || static_cast<std::size_t>(status.st_size) < firstSlot())
+        {
+            close(fd);
+            throw std::runtime_error{
+                "SharedAVLTree(), shared memory object " + name + " is not a tree"};
+        }
+
+        m_length = static_cast<std::size_t>(status.st_size);
+        void* mapping = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if(mapping == MAP_FAILED)
+            throw std::runtime_error{
+                "SharedAVLTree(), cannot map shared memory object " + name};
+
+        m_base = static_cast<unsigned char*>(mapping);
+        m_header = reinterpret_cast<Header*>(m_base);
+
+        if(m_header->magic != s_magic || m_header->valueSize != sizeof(T) || m_header->bytes != m_length)
+        {
+            munmap(m_base, m_length);                                                   // not written by a SharedAVLTree<T>, or not finished initializing
+            throw std::runtime_error{
+                "SharedAVLTree(), shared memory object " + name + " does not hold a tree of this type"};
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }                                                                                   // opening constructor end //
+
+    template <typename T>
+    SharedAVLTree<T>::~SharedAVLTree()       // destructor start //
+    {
+        if(m_base != nullptr)
+            munmap(m_base, m_length);        // the nodes live in the segment, there is nothing else to free
+    }                                        // destructor end //
+
+    template <typename T>
+    void SharedAVLTree<T>::unlink(const std::string& name)   // unlink function start //
+    {
+        shm_unlink(name.c_str());
+    }                                                        // unlink function end //
+
+    template <typename T>
+    T* SharedAVLTree<T>::insert(const T& newValue)                  // insert function start //
+    {
+        if(!m_writer)
+            throw std::runtime_error{
+                "SharedAVLTree insert(), tree is mapped read only"};
+
+        if(m_header->root.load(std::memory_order_relaxed) == 0)     // empty tree condition
+        {
+            Node* newNode = allocate(newValue);                     // allocate before the write section, it may throw
+
+            beginWrite();
+            m_header->root.store(offset(newNode), std::memory_order_relaxed);
+            m_header->size.store(1, std::memory_order_relaxed);
+            endWrite();
+            return nullptr;                                         // return nullptr for successful insertion
+        }
+
+        std::stack<Node*> stack{stackNodes(newValue)};
+
+        if(stack.top() != nullptr)                                  // if value already exists
+            return &(stack.top()->value);                           // return pointer to its value
+
+        stack.pop();                                                // top most node is nullptr so pop it off
+        Node* parentNode = stack.top();                             // the parent node of new node is the top most node on the stack
+        Node* newNode = allocate(newValue);
+
+        beginWrite();
+        newNode->parent = offset(parentNode);
+
+        if(parentNode->value > newValue)                            // value is less than parent, making it the left child
+            parentNode->left = offset(newNode);
+
+        else                                                        // value is greater than the parent, making it the right child
+            parentNode->right = offset(newNode);
+
+        unstackNodes(stack);                                        // update and balance nodes in the stack
+        m_header->size.fetch_add(1, std::memory_order_relaxed);     // increment the size
+        endWrite();
+
+        return nullptr;                                             // return nullptr for a successful insertion
+    }                                                               // insert function end //
+
+    template <typename T>
+    T SharedAVLTree<T>::remove(const T& value)                                     // remove function start //
+    {
+        if(!m_writer)
+            throw std::runtime_error{
+                "SharedAVLTree remove(), tree is mapped read only"};
+
+        if(m_header->root.load(std::memory_order_relaxed) == 0)
+            throw std::runtime_error{
+                "SharedAVLTree remove(), cannot remove value, value does not exist"};
+
+        std::stack<Node*> stack{stackNodes(value)};
+        Node* removingNode = stack.top();
+
+        if(removingNode == nullptr)                                                // if value was not found, throw an error
+            throw std::runtime_error{
+                "SharedAVLTree remove(), cannot remove value, value does not exist"};
+
+        T nodeValue = removingNode->value;                                         // save the nodes value to return later
+
+        beginWrite();
+
+        if(removingNode->left != 0 && removingNode->right != 0)                    // the node has two subtrees
+        {
+            Node* successor = node(removingNode->right);                           // the successor is the left most node of the right subtree
+            stack.push(successor);
+
+            while(successor->left != 0)
+            {
+                successor = node(successor->left);
+                stack.push(successor);
+            }
+
+            removingNode->value = successor->value;                                // the successor's value moves up, and its node is removed instead
+            removingNode = successor;
+        }
+
+        stack.pop();                                                               // the removed node is not updated, its parent is the new top
+        Node* subtree = node(removingNode->left != 0 ? removingNode->left : removingNode->right);
+
+        replaceChild(node(removingNode->parent), removingNode, subtree);          // the node has at most one subtree now, it takes the node's place
+        release(removingNode);
+
+        unstackNodes(stack);                                                       // unstack the nodes, updating and balancing them all
+        m_header->size.fetch_sub(1, std::memory_order_relaxed);                    // decrement the size
+        endWrite();
+
+        return nodeValue;                                                          // return the removed nodes value
+    }                                                                              // remove function end //
+
+    template <typename T>
+    bool SharedAVLTree<T>::find(const T& value, T* result) const                  // find function start //
+    {
+        for(std::size_t attempt = 0;; ++attempt)
+        {
+            if(attempt == s_maxRetries)                                            // the sequence never settled, the writer is stuck or gone
+                throw std::runtime_error{
+                    "SharedAVLTree find(), writer did not finish its mutation"};
+
+            if(attempt != 0)
+                backoff(attempt);
+
+            std::uint64_t before = m_header->sequence.load(std::memory_order_acquire);
+
+            if(before & 1)                                                         // the writer is in the middle of a mutation, try again
+                continue;
+
+            bool found = false;
+            T foundValue{};
+            Offset current = m_header->root.load(std::memory_order_relaxed);
+
+            for(int depth = 0; depth < s_maxDepth && validOffset(current); ++depth)
+            {
+                Node copy;
+                std::memcpy(&copy, node(current), sizeof(Node));                  // take a private copy, the shared node may change under us
+
+                if(copy.value > value)                                             // if value is less than the node's value go left
+                    current = copy.left;
+
+                else if(copy.value < value)                                        // if value is greater than the node's value go right
+                    current = copy.right;
+
+                else                                                               // not less, nor greater, it must be equal, so we found it
+                {
+                    found = true;
+                    foundValue = copy.value;
+                    break;
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if(m_header->sequence.load(std::memory_order_relaxed) != before)       // the writer changed the tree while we read it, try again
+                continue;
+
+            if(found && result != nullptr)
+                *result = foundValue;
+
+            return found;
+        }
+    }                                                                              // find function end //
+
+    template <typename T>
+    bool SharedAVLTree<T>::empty() const                  // empty function start //
+    {
+        return size() == 0;
+    }                                                     // empty function end //
+
+    template <typename T>
+    std::size_t SharedAVLTree<T>::size() const            // size function start //
+    {
+        return m_header->size.load(std::memory_order_acquire);
+    }                                                     // size function end //
+
+    template <typename T>
+    std::uint64_t SharedAVLTree<T>::version() const       // version function start //
+    {
+        return m_header->sequence.load(std::memory_order_acquire);
+    }                                                     // version function end //
+
+    template <typename T>
+    std::size_t SharedAVLTree<T>::capacity() const        // capacity function start //
+    {
+        return (m_length - firstSlot()) / sizeof(Node);
+    }                                                     // capacity function end //
+
+    template <typename T>
+    typename SharedAVLTree<T>::Node* SharedAVLTree<T>::node(Offset nodeOffset) const
+    {                                                                                  // node function start //
+        if(nodeOffset == 0)
+            return nullptr;
+        return reinterpret_cast<Node*>(m_base + nodeOffset);
+    }                                                                                  // node function end //
+
+    template <typename T>
+    typename SharedAVLTree<T>::Offset SharedAVLTree<T>::offset(const Node* nodePointer) const
+    {                                                                                  // offset function start //
+        if(nodePointer == nullptr)
+            return 0;
+        return static_cast<Offset>(reinterpret_cast<const unsigned char*>(nodePointer) - m_base);
+    }                                                                                  // offset function end //
+
+    template <typename T>
+    bool SharedAVLTree<T>::validOffset(Offset nodeOffset) const                       // validOffset function start //
+    {
+        if(nodeOffset < firstSlot() || nodeOffset + sizeof(Node) > m_length)           // 0 and anything outside the mapping is rejected
+            return false;
+        return (nodeOffset - firstSlot()) % sizeof(Node) == 0;                         // offsets must land on a slot boundary
+    }                                                                                  // validOffset function end //
+
+    template <typename T>
+    typename SharedAVLTree<T>::Offset SharedAVLTree<T>::firstSlot()                  // firstSlot function start //
+    {
+        return (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node); // header size rounded up to the node alignment
+    }                                                                                  // firstSlot function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::beginWrite()                                               // beginWrite function start //
+    {
+        std::uint64_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+        m_header->sequence.store(sequence + 1, std::memory_order_relaxed);             // odd, readers that start now will wait
+        std::atomic_thread_fence(std::memory_order_release);                           // keep the node writes after the counter change
+    }                                                                                  // beginWrite function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::endWrite()                                                 // endWrite function start //
+    {
+        std::uint64_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+        m_header->sequence.store(sequence + 1, std::memory_order_release);             // even again, publishes the node writes
+    }                                                                                  // endWrite function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::backoff(std::size_t attempt)                               // backoff function start //
+    {
+        if(attempt < s_spinRetries)                                                    // a mutation is a few rotations, it usually ends while we spin
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+            return;
+        }
+
+        if(attempt < s_yieldRetries)
+            std::this_thread::yield();                                                 // the writer may be waiting for our core
+
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds{50});               // the writer was descheduled or is stuck, stop burning the core
+    }                                                                                  // backoff function end //
+
+    template <typename T>
+    typename SharedAVLTree<T>::Node* SharedAVLTree<T>::allocate(const T& value)      // allocate function start //
+    {
+        Node* newNode;
+
+        if(m_header->freeList != 0)                                                    // reuse a removed node if there is one
+        {
+            newNode = node(m_header->freeList);
+            m_header->freeList = newNode->left;
+        }
+
+        else if(m_header->next + sizeof(Node) <= m_length)                             // otherwise take the next unused slot
+        {
+            newNode = node(m_header->next);
+            m_header->next += sizeof(Node);
+        }
+
+        else
+            throw std::runtime_error{
+                "SharedAVLTree insert(), segment is full"};
+
+        newNode->value = value;                                                        // the node is not linked yet, readers cannot reach it
+        newNode->parent = 0;
+        newNode->left = 0;
+        newNode->right = 0;
+        newNode->height = 0;
+        newNode->balanceFactor = 0;
+        return newNode;
+    }                                                                                  // allocate function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::release(Node* oldNode)         // release function start //
+    {
+        oldNode->left = m_header->freeList;               // push the node onto the free list
+        m_header->freeList = offset(oldNode);
+    }                                                     // release function end //
+
+    template <typename T>
+    std::stack<typename SharedAVLTree<T>::Node*> SharedAVLTree<T>::stackNodes(const T& value)
+    {                                                     // stackNodes function start //
+        std::stack<Node*> stack;
+        stack.push(node(m_header->root.load(std::memory_order_relaxed)));
+
+        while(true)
+        {
+            Node* currentNode = stack.top();
+
+            if(currentNode == nullptr)                    // if the currentNode is nullptr, return the stack
+                return stack;
+
+            else if(currentNode->value > value)           // the value belongs in the left subtree
+                stack.push(node(currentNode->left));
+
+            else if(currentNode->value < value)           // the value belongs in the right subtree
+                stack.push(node(currentNode->right));
+
+            else                                          // currentNode->value == value
+                return stack;
+        }
+    }                                                     // stackNodes function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::unstackNodes(std::stack<Node*>& stack) // unstackNodes function start //
+    {
+        while(!stack.empty())
+        {
+            Node* currentNode = stack.top();
+
+            if(currentNode != nullptr)                              // update and balance every real node on the way up
+            {
+                update(currentNode);
+                balance(currentNode);
+            }
+
+            stack.pop();
+        }
+    }                                                               // unstackNodes function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::update(Node* currentNode)                                   // update function start //
+    {
+        std::int32_t leftHeight = -1;
+        std::int32_t rightHeight = -1;
+
+        if(currentNode->left != 0)                                                     // if the node has a left child get its height
+            leftHeight = node(currentNode->left)->height;
+
+        if(currentNode->right != 0)                                                    // if the node has a right child get its height
+            rightHeight = node(currentNode->right)->height;
+
+        currentNode->height = (rightHeight >= leftHeight ? rightHeight : leftHeight) + 1;
+        currentNode->balanceFactor = rightHeight - leftHeight;
+    }                                                                                  // update function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::balance(Node* currentNode)              // balance function start //
+    {
+        if(currentNode->balanceFactor == -2)                       // tree is left heavy
+        {
+            if(node(currentNode->left)->balanceFactor == 1)        // left right case
+                leftRotation(node(currentNode->left));
+
+            rightRotation(currentNode);
+        }
+
+        else if(currentNode->balanceFactor == 2)                   // tree is right heavy
+        {
+            if(node(currentNode->right)->balanceFactor == -1)      // right left case
+                rightRotation(node(currentNode->right));
+
+            leftRotation(currentNode);
+        }
+    }                                                              // balance function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::rightRotation(Node* A)       // rightRotation function start //
+    {
+        Node* B = node(A->left);                        // B is A's left child
+
+        A->left = B->right;                             // B's right child becomes A's left child
+        if(B->right != 0)
+            node(B->right)->parent = offset(A);
+
+        replaceChild(node(A->parent), A, B);            // B takes A's place
+
+        B->right = offset(A);                           // and A becomes B's right child
+        A->parent = offset(B);
+
+        update(A);                                      // update A & B
+        update(B);
+    }                                                   // rightRotation function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::leftRotation(Node* A)        // leftRotation function start //
+    {
+        Node* B = node(A->right);                       // B is A's right child
+
+        A->right = B->left;                             // B's left child becomes A's right child
+        if(B->left != 0)
+            node(B->left)->parent = offset(A);
+
+        replaceChild(node(A->parent), A, B);            // B takes A's place
+
+        B->left = offset(A);                            // and A becomes B's left child
+        A->parent = offset(B);
+
+        update(A);                                      // update A & B
+        update(B);
+    }                                                   // leftRotation function end //
+
+    template <typename T>
+    void SharedAVLTree<T>::replaceChild(Node* parent, Node* oldChild, Node* newChild)
+    {                                                                                  // replaceChild function start //
+        if(newChild != nullptr)
+            newChild->parent = offset(parent);
+
+        if(parent == nullptr)                                                          // oldChild was the root
+            m_header->root.store(offset(newChild), std::memory_order_relaxed);
+
+        else if(parent->left == offset(oldChild))
+            parent->left = offset(newChild);
+
+        else
+            parent->right = offset(newChild);
+    }                                                                                  // replaceChild function end //
+}
@@ -0,0 +1,265 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // AVLTree with a small size optimization, up to N values live in a sorted array inside the object itself
+    // a tree with few values costs no heap allocation at all, the first insert past N moves every value into an AVLTree,
+    // and once removals bring the size down to N / 2 the values move back inline
+    // while the values are inline, insert() and remove() shift them, so pointers returned by find() only stay valid until the next insert or remove
+    // this is a wrapper rather than inline storage inside AVLTree itself, so plain AVLTrees keep their size and their find() has no layout branch
+    template <class T, std::size_t N = 8, class Augmentation = NoAugmentation>
+    class SmallAVLTree
+    {
+        static_assert(N > 0, "SmallAVLTree needs room for at least one inline value");
+
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::ConstIterator TreeIterator;
+
+        alignas(T) unsigned char m_storage[N * sizeof(T)];   // raw storage for the inline values, the first m_inlineSize are constructed and sorted
+        std::size_t m_inlineSize;                            // number of inline values, 0 once spilled
+        std::unique_ptr<Tree> m_tree;                        // holds the values once more than N were inserted, nullptr while inline
+
+        public:
+
+        class ConstIterator                          // in order iterator over either layout
+        {
+            friend class SmallAVLTree<T, N, Augmentation>;
+
+            const T* m_inline;                       // current inline value, nullptr in the tree layout
+            TreeIterator m_node;                     // current tree position, unused in the inline layout
+
+            ConstIterator(const T* value, TreeIterator node) : m_inline{value}, m_node{node} {}
+
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            ConstIterator() : m_inline{nullptr}, m_node{} {}
+
+            const T& operator*() const { return m_inline != nullptr ? *m_inline : *m_node; }
+            const T* operator->() const { return &**this; }
+
+            ConstIterator& operator++()
+            {
+                if(m_inline != nullptr)
+                    ++m_inline;
+                else
+                    ++m_node;
+                return *this;
+            }
+
+            ConstIterator operator++(int)
+            {
+                ConstIterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const ConstIterator& other) const { return m_inline == other.m_inline && m_node == other.m_node; }
+            bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+        };
+
+        SmallAVLTree() : m_inlineSize{0}, m_tree{} {}                // constructor
+        SmallAVLTree(const SmallAVLTree&) = delete;                  // copy constructor disabled
+        ~SmallAVLTree();                                             // destructor
+
+        T* insert(const T&);                         // insert an element, returns a pointer to an element if it already exists, otherwise returns nullptr
+        T remove(const T&);                          // remove an element, returns the value removed, if it does not exist an exception is thrown
+
+        T* find(const T&);                           // trys to find an element, returns a pointer to it or nullptr
+        const T* find(const T&) const;               // const version of find
+
+        ConstIterator begin() const;                 // returns an iterator to the smallest value
+        ConstIterator end() const;                   // returns the past the end iterator
+
+        bool empty() const { return size() == 0; }                                      // returns true if the tree is empty
+        std::size_t size() const { return m_tree ? m_tree->size() : m_inlineSize; }     // returns the number of elements
+        bool isInline() const { return !m_tree; }                                       // returns true while the values live inside the object
+
+        private:
+
+        T* values() { return reinterpret_cast<T*>(m_storage); }
+        const T* values() const { return reinterpret_cast<const T*>(m_storage); }
+
+        std::size_t position(const T&) const;        // returns the index of the first inline value not less than the given value
+
+        void spill();                                // moves the inline values into a new AVLTree
+        void unspill() noexcept;                     // moves the tree's values back inline and frees the tree, keeps the tree layout if a copy throws
+    };
+
+    template <typename T, std::size_t N, typename Augmentation>
+    SmallAVLTree<T, N, Augmentation>::~SmallAVLTree()                       // destructor start //
+    {
+        for(std::size_t i = 0; i < m_inlineSize; ++i)
+            values()[i].~T();
+    }                                                                       // destructor end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    T* SmallAVLTree<T, N, Augmentation>::insert(const T& newValue)          // insert function start //
+    {
+        if(m_tree)
+            return m_tree->insert(newValue);
+
+        std::size_t index = position(newValue);
+
+        if(index < m_inlineSize && !(newValue < values()[index]))           // already inline
+            return &values()[index];
+
+        if(m_inlineSize == N)                                               // full, the value goes into the tree with the rest
+        {
+            spill();
+            return m_tree->insert(newValue);
+        }
+
+        T* array = values();
+
+        if(index == m_inlineSize)
+            new (&array[index]) T{newValue};
+        else
+        {
+            new (&array[m_inlineSize]) T{std::move(array[m_inlineSize - 1])};   // shift the larger values up by one
+            for(std::size_t i = m_inlineSize - 1; i > index; --i)
+                array[i] = std::move(array[i - 1]);
+            array[index] = newValue;
+        }
+
+        ++m_inlineSize;
+        return nullptr;                                                     // return nullptr for a successful insertion
+    }                                                                       // insert function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    T SmallAVLTree<T, N, Augmentation>::remove(const T& value)              // remove function start //
+    {
+        if(m_tree)
+        {
+            T removed = m_tree->remove(value);
+
+            if(m_tree->size() <= N / 2)                                     // well below the limit, so a few inserts will not spill again
+                unspill();                                                  // never throws, the value is already gone from the tree
+
+            return removed;
+        }
+
+        std::size_t index = position(value);
+
+        if(index == m_inlineSize || value < values()[index])
+            throw std::runtime_error{
+                "SmallAVLTree remove(), cannot remove value, value does not exist"};
+
+        T* array = values();
+        T removed = std::move(array[index]);
+
+        for(std::size_t i = index; i + 1 < m_inlineSize; ++i)               // close the gap
+            array[i] = std::move(array[i + 1]);
+
+        array[--m_inlineSize].~T();
+        return removed;
+    }                                                                       // remove function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    T* SmallAVLTree<T, N, Augmentation>::find(const T& value)               // find function start //
+    {
+        if(m_tree)
+            return m_tree->find(value);
+
+        std::size_t index = position(value);
+
+        if(index < m_inlineSize && !(value < values()[index]))
+            return &values()[index];
+        return nullptr;
+    }                                                                       // find function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    const T* SmallAVLTree<T, N, Augmentation>::find(const T& value) const   // const find function start //
+    {
+        if(m_tree)
+            return static_cast<const Tree&>(*m_tree).find(value);
+
+        std::size_t index = position(value);
+
+        if(index < m_inlineSize && !(value < values()[index]))
+            return &values()[index];
+        return nullptr;
+    }                                                                       // const find function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    typename SmallAVLTree<T, N, Augmentation>::ConstIterator SmallAVLTree<T, N, Augmentation>::begin() const
+    {                                                                       // begin function start //
+        if(m_tree)
+            return ConstIterator{nullptr, m_tree->begin()};
+
+        if(m_inlineSize == 0)
+            return end();
+        return ConstIterator{values(), TreeIterator{}};
+    }                                                                       // begin function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    typename SmallAVLTree<T, N, Augmentation>::ConstIterator SmallAVLTree<T, N, Augmentation>::end() const
+    {                                                                       // end function start //
+        if(m_tree || m_inlineSize == 0)
+            return ConstIterator{};
+        return ConstIterator{values() + m_inlineSize, TreeIterator{}};      // one past the last inline value
+    }                                                                       // end function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    std::size_t SmallAVLTree<T, N, Augmentation>::position(const T& value) const
+    {                                                                       // position function start //
+        const T* array = values();
+        std::size_t index = 0;
+
+        while(index < m_inlineSize && array[index] < value)                 // a linear scan beats a binary search over a few values, and never mispredicts until the end
+            ++index;
+
+        return index;
+    }                                                                       // position function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    void SmallAVLTree<T, N, Augmentation>::spill()                          // spill function start //
+    {
+        std::unique_ptr<Tree> tree{new Tree{}};
+
+        for(std::size_t i = 0; i < m_inlineSize; ++i)
+            tree->insert(values()[i]);
+
+        for(std::size_t i = 0; i < m_inlineSize; ++i)                       // only destroy the inline values once the tree holds them all
+            values()[i].~T();
+
+        m_inlineSize = 0;
+        m_tree = std::move(tree);
+    }                                                                       // spill function end //
+
+    template <typename T, std::size_t N, typename Augmentation>
+    void SmallAVLTree<T, N, Augmentation>::unspill() noexcept               // unspill function start //
+    {
+        T* array = values();
+
+        try
+        {
+            for(const T& value : *m_tree)                                   // the tree yields the values in order
+            {
+                new (&array[m_inlineSize]) T{value};
+                ++m_inlineSize;
+            }
+        }
+        catch(...)                                                          // keep the tree layout if a copy throws, the removal that called us already succeeded
+        {
+            while(m_inlineSize > 0)
+                array[--m_inlineSize].~T();
+            return;
+        }
+
+        m_tree.reset();
+    }                                                                       // unspill function end //
+}
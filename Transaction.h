@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    template <class T, class Augmentation>
+    class Transaction;
+
+    // AVLTree shared between reader threads and writers, readers hold a shared lock, writers an exclusive one
+    // a Transaction applies all its changes under one exclusive lock, so readers see the tree before or after it, never in between
+    template <class T, class Augmentation = NoAugmentation>
+    class ConcurrentAVLTree
+    {
+        friend class Transaction<T, Augmentation>;
+
+        AVLTree<T, Augmentation> m_tree;
+        mutable std::shared_mutex m_mutex;
+
+        public:
+
+        ConcurrentAVLTree() : m_tree{}, m_mutex{} {}                        // constructor
+        ConcurrentAVLTree(const ConcurrentAVLTree&) = delete;               // copy constructor disabled
+
+        bool insert(const T&);                       // inserts under the exclusive lock, returns false if the value already exists
+        T remove(const T&);                          // removes under the exclusive lock, returns the value removed, throws if it does not exist
+
+        bool find(const T&, T* result = nullptr) const;  // trys to find an element under the shared lock, if found it is copied into result and true is returned
+
+        template <class Function>
+        void read(Function function) const;          // calls function(const AVLTree<T, Augmentation>&) under the shared lock, for scans and several lookups at one version
+
+        std::size_t size() const;                    // returns the number of elements
+    };
+
+    // buffers inserts and removes against a ConcurrentAVLTree and applies them all or none
+    // commit() sorts the operations by value, which keeps the tree paths of neighbouring operations in cache,
+    // under the lock it checks every remove with one batch lookup and makes the nodes of every added value before the first change,
+    // linking and unlinking those nodes allocates nothing, so a commit either fails with the tree untouched or cannot fail, comparisons must not throw
+    template <class T, class Augmentation = NoAugmentation>
+    class Transaction
+    {
+        enum class Operation
+        {
+            Insert,
+            Remove
+        };
+
+        struct Step
+        {
+            Operation operation;
+            T value;
+            std::size_t order;                       // position in the transaction, ties on value keep it
+        };
+
+        ConcurrentAVLTree<T, Augmentation>& m_target;
+        std::vector<Step> m_steps;                   // operations not committed yet
+
+        public:
+
+        explicit Transaction(ConcurrentAVLTree<T, Augmentation>& target) : m_target{target}, m_steps{} {}
+
+        void insert(const T& value) { m_steps.push_back(Step{Operation::Insert, value, m_steps.size()}); }  // buffers an insert, inserting an existing value is not an error
+        void remove(const T& value) { m_steps.push_back(Step{Operation::Remove, value, m_steps.size()}); }  // buffers a remove, removing a missing value fails the commit
+
+        void commit();                               // applies every buffered operation, throws with the tree unchanged if a remove finds no value or an allocation fails
+        void rollback() { m_steps.clear(); }         // forgets every buffered operation
+
+        std::size_t pending() const { return m_steps.size(); }   // returns the number of buffered operations
+    };
+
+    template <typename T, typename Augmentation>
+    bool ConcurrentAVLTree<T, Augmentation>::insert(const T& value)         // insert function start //
+    {
+        std::unique_lock<std::shared_mutex> lock{m_mutex};
+        return m_tree.insert(value) == nullptr;
+    }                                                                       // insert function end //
+
+    template <typename T, typename Augmentation>
+    T ConcurrentAVLTree<T, Augmentation>::remove(const T& value)            // remove function start //
+    {
+        std::unique_lock<std::shared_mutex> lock{m_mutex};
+        return m_tree.remove(value);
+    }                                                                       // remove function end //
+
+    template <typename T, typename Augmentation>
+    bool ConcurrentAVLTree<T, Augmentation>::find(const T& value, T* result) const
+    {                                                                       // find function start //
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        const T* found = m_tree.find(value);
+
+        if(found == nullptr)
+            return false;
+
+        if(result != nullptr)
+            *result = *found;
+        return true;
+    }                                                                       // find function end //
+
+    template <typename T, typename Augmentation>
+    template <class Function>
+    void ConcurrentAVLTree<T, Augmentation>::read(Function function) const  // read function start //
+    {
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        function(static_cast<const AVLTree<T, Augmentation>&>(m_tree));
+    }                                                                       // read function end //
+
+    template <typename T, typename Augmentation>
+    std::size_t ConcurrentAVLTree<T, Augmentation>::size() const            // size function start //
+    {
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        return m_tree.size();
+    }                                                                       // size function end //
+
+    template <typename T, typename Augmentation>
+    void Transaction<T, Augmentation>::commit()                             // commit function start //
+    {
+        typedef typename AVLTree<T, Augmentation>::Node Node;
+
+        std::vector<T> keys;                                                // every value once, sorted, for the batch lookup
+        std::vector<const T*> found;                                        // the tree's copy of each key, nullptr if it is missing
+        std::vector<std::size_t> leaving;                                   // keys whose node in the tree is removed
+        std::vector<Node*> attaching;                                       // nodes of the values added, made before the first change
+        std::vector<Node*> detached;                                        // nodes taken out of the tree, deleted once the lock is released
+
+        try
+        {
+            std::sort(m_steps.begin(), m_steps.end(), [](const Step& a, const Step& b)
+            {
+                if(a.value < b.value)
+                    return true;
+                if(b.value < a.value)
+                    return false;
+                return a.order < b.order;                                   // same value, keep the order they were made in
+            });
+
+            keys.reserve(m_steps.size());
+            for(std::size_t i = 0; i < m_steps.size(); ++i)
+                if(i == 0 || m_steps[i - 1].value < m_steps[i].value)
+                    keys.push_back(m_steps[i].value);
+
+            found.reserve(keys.size());                                     // nothing below grows past these
+            leaving.reserve(keys.size());
+            attaching.reserve(keys.size());
+            detached.reserve(keys.size());
+
+            std::unique_lock<std::shared_mutex> lock{m_target.m_mutex};
+            AVLTree<T, Augmentation>& tree = m_target.m_tree;
+
+            static_cast<const AVLTree<T, Augmentation>&>(tree).findSortedBatch(keys, found); // one traversal for every key, the const version counts no adaptive hits
+
+            std::size_t step = 0;
+            for(std::size_t key = 0; key < keys.size(); ++key)              // replay each value's operations against whether it is in the tree, nothing changes yet
+            {
+                bool present = found[key] != nullptr;
+                bool original = present;                                    // the tree's own node is still in
+                const T* added = nullptr;                                   // the inserted value that is in, nullptr if none
+
+                for(; step < m_steps.size() && !(keys[key] < m_steps[step].value); ++step)
+                {
+                    if(m_steps[step].operation == Operation::Insert)
+                    {
+                        if(!present)                                        // inserting an existing value changes nothing
+                            added = &m_steps[step].value;
+                        present = true;
+                    }
+
+                    else if(!present)
+                        throw std::runtime_error{
+                            "Transaction commit(), cannot remove value, value does not exist"};
+
+                    else
+                    {
+                        if(added != nullptr)
+                            added = nullptr;
+                        else
+                            original = false;
+                        present = false;
+                    }
+                }
+
+                if(found[key] != nullptr && !original)
+                    leaving.push_back(key);
+
+                if(added != nullptr)
+                    attaching.push_back(new Node{*added});                  // may throw, the tree is still untouched
+            }
+
+            for(std::size_t key : leaving)                                  // from here on nothing allocates, so there is nothing to roll back,
+                detached.push_back(tree.detach(keys[key]));                 // removals go first, a value removed and inserted again is replaced
+
+            for(Node* node : attaching)
+                tree.attach(node);
+        }
+        catch(...)
+        {
+            for(Node* node : attaching)                                     // only reached before the first change
+                delete node;
+
+            m_steps.clear();
+            throw;
+        }
+
+        for(Node* node : detached)
+            delete node;
+
+        m_steps.clear();
+    }                                                                       // commit function end //
+}
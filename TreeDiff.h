@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // computes the values added and removed between two versions of a tree
+    // with hashing on in both trees, every subtree of the base is compared against the same key range of the updated tree by hash,
+    // equal ranges are skipped whole, so d differences cost O(d log^2 n) instead of a walk over both trees,
+    // otherwise, if the trees' augmentation keeps no hashes or either tree has hashing off, both trees are merged linearly
+    // a hash collision would hide a difference, with 64 bit hashes that is a 2^-64 chance per compared range
+    template <class T, class Augmentation>
+    class TreeDiff
+    {
+        typedef AVLTree<T, Augmentation> Tree;
+        typedef typename Tree::Node Node;
+
+        public:
+
+        template <class OnAdded, class OnRemoved>
+        static void diff(const Tree& base, const Tree& updated, OnAdded onAdded, OnRemoved onRemoved);  // calls onAdded(value) for values only in updated and onRemoved(value) for values only in base
+
+        template <class OnAdded, class OnRemoved>
+        static void mergeDiff(const Tree& base, const Tree& updated, OnAdded onAdded, OnRemoved onRemoved); // the linear merge, used when the trees are not hashed
+
+        private:
+
+        template <class OnAdded, class OnRemoved>
+        static void diffNode(const Node*, const T* low, const T* high, const Tree& updated,
+                             OnAdded& onAdded, OnRemoved& onRemoved);  // diffs the base subtree against updated's values strictly between low and high, nullptr bounds are open
+
+        static std::uint64_t between(const Tree&, const T* low, const T* high);  // returns the hash of the values strictly between the bounds
+
+        template <class Function>
+        static void each(const Tree&, const T* low, const T* high, Function& report); // reports every value strictly between the bounds
+    };
+
+    template <class T, class Augmentation, class OnAdded, class OnRemoved>
+    void diff(const AVLTree<T, Augmentation>& base, const AVLTree<T, Augmentation>& updated, OnAdded onAdded, OnRemoved onRemoved)
+    {                                                                                                   // diff function start //
+        TreeDiff<T, Augmentation>::diff(base, updated, onAdded, onRemoved);
+    }                                                                                                   // diff function end //
+
+    template <typename T, typename Augmentation>
+    template <class OnAdded, class OnRemoved>
+    void TreeDiff<T, Augmentation>::diff(const Tree& base, const Tree& updated, OnAdded onAdded, OnRemoved onRemoved)
+    {                                                                                                   // diff function start //
+        if(&base == &updated)
+            return;
+
+        if constexpr(!Augmentation::hashes)
+            mergeDiff(base, updated, onAdded, onRemoved);
+
+        else if(!base.hashing() || !updated.hashing())
+            mergeDiff(base, updated, onAdded, onRemoved);
+
+        else
+            diffNode(base.m_root, nullptr, nullptr, updated, onAdded, onRemoved);
+    }                                                                                                   // diff function end //
+
+    template <typename T, typename Augmentation>
+    template <class OnAdded, class OnRemoved>
+    void TreeDiff<T, Augmentation>::mergeDiff(const Tree& base, const Tree& updated, OnAdded onAdded, OnRemoved onRemoved)
+    {                                                                                                   // mergeDiff function start //
+        typename Tree::ConstIterator left = base.begin();
+        typename Tree::ConstIterator right = updated.begin();
+
+        while(left != base.end() && right != updated.end())
+        {
+            if(*left < *right)
+                onRemoved(*left++);
+
+            else if(*right < *left)
+                onAdded(*right++);
+
+            else
+            {
+                ++left;
+                ++right;
+            }
+        }
+
+        for(; left != base.end(); ++left)
+            onRemoved(*left);
+
+        for(; right != updated.end(); ++right)
+            onAdded(*right);
+    }                                                                                                   // mergeDiff function end //
+
+    template <typename T, typename Augmentation>
+    template <class OnAdded, class OnRemoved>
+    void TreeDiff<T, Augmentation>::diffNode(const Node* node, const T* low, const T* high, const Tree& updated,
+                               OnAdded& onAdded, OnRemoved& onRemoved)
+    {                                                                                                   // diffNode function start //
+        if(Tree::hashOf(node) == between(updated, low, high))                                     // same values on both sides, skip them all
+            return;
+
+        if(node == nullptr)                                                                             // nothing here in the base, everything in updated is new
+        {
+            each(updated, low, high, onAdded);
+            return;
+        }
+
+        diffNode(node->left, low, &node->value, updated, onAdded, onRemoved);                           // children first keeps the callbacks in order
+
+        if(updated.find(node->value) == nullptr)
+            onRemoved(node->value);
+
+        diffNode(node->right, &node->value, high, updated, onAdded, onRemoved);
+    }                                                                                                   // diffNode function end //
+
+    template <typename T, typename Augmentation>
+    std::uint64_t TreeDiff<T, Augmentation>::between(const Tree& tree, const T* low, const T* high)
+    {                                                                                                   // between function start //
+        std::uint64_t below = high == nullptr ? Tree::hashOf(tree.m_root) : tree.prefixHash(*high, false);
+        std::uint64_t upToLow = low == nullptr ? 0 : tree.prefixHash(*low, true);
+        return below - upToLow;
+    }                                                                                                   // between function end //
+
+    template <typename T, typename Augmentation>
+    template <class Function>
+    void TreeDiff<T, Augmentation>::each(const Tree& tree, const T* low, const T* high, Function& report)
+    {                                                                                                   // each function start //
+        typename Tree::ConstIterator current = low == nullptr ? tree.begin() : tree.lowerBound(*low);
+
+        if(low != nullptr && current != tree.end() && !(*low < *current))                              // the bound itself is excluded
+            ++current;
+
+        for(; current != tree.end() && (high == nullptr || *current < *high); ++current)
+            report(*current);
+    }                                                                                                   // each function end //
+}
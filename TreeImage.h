@@ -0,0 +1,176 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // serialized tree image, a small header followed by the values in increasing order as raw bytes
+    // a sorted array is an implicit perfectly balanced tree, the middle value of any range is the root of the subtree over that range,
+    // so an image is written in one sequential pass and can be loaded back into a balanced AVLTree in O(n) without comparisons
+    struct TreeImageHeader
+    {
+        std::uint64_t magic;                         // s_treeImageMagic
+        std::uint32_t valueSize;                     // sizeof(T) of the writer, checked by the reader
+        std::uint32_t reserved;                      // zero
+        std::uint64_t count;                         // number of values following the header
+    };
+
+    static const std::uint64_t s_treeImageMagic = 0x4547414d494c5641; // "AVLIMAGE"
+
+    // streams increasing values into an image file, finish() writes the final count into the header
+    template <class T>
+    class TreeImageWriter
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "TreeImageWriter stores raw bytes of T");
+
+        std::ofstream m_out;                         // image being written
+        std::vector<T> m_buffer;                     // values not yet written, flushed in large sequential writes
+        std::uint64_t m_count;                       // values appended so far
+        T m_last;                                    // last value appended, valid once m_count is not zero
+        bool m_finished;
+
+        public:
+
+        explicit TreeImageWriter(const std::string& path, std::size_t bufferValues = 1 << 16); // creates or truncates the file, throws if it cannot be opened
+        TreeImageWriter(const TreeImageWriter<T>&) = delete;                                   // copy constructor disabled
+
+        void append(const T&);                       // adds the next value, throws unless it is larger than the previous one
+        void finish();                               // flushes the values and the header, further appends throw
+
+        std::uint64_t count() const { return m_count; }                                        // returns the number of values appended
+        std::uint64_t bytes() const { return sizeof(TreeImageHeader) + m_count * sizeof(T); } // returns the size of the finished image
+
+        private:
+
+        void flush();                                // writes the buffered values
+    };
+
+    template <class T, class Augmentation>
+    void writeTreeImage(const AVLTree<T, Augmentation>&, const std::string& path);    // writes every value of the tree as an image
+
+    template <class T>
+    std::uint64_t readTreeImageHeader(std::ifstream&, const std::string& path); // checks the header of an opened image, returns its count, throws if it is not an image of T
+
+    template <class T, class Augmentation>
+    void readTreeImage(const std::string& path, AVLTree<T, Augmentation>&);           // replaces the tree's contents with the image's values
+
+    template <typename T>
+    TreeImageWriter<T>::TreeImageWriter(const std::string& path, std::size_t bufferValues) :
+        m_out{path, std::ios::binary | std::ios::trunc}, m_buffer{}, m_count{0}, m_last{}, m_finished{false}
+    {                                                                                   // constructor start //
+        if(!m_out)
+            throw std::runtime_error{
+                "TreeImageWriter TreeImageWriter(), cannot open " + path};
+
+        m_buffer.reserve(bufferValues == 0 ? 1 : bufferValues);
+
+        TreeImageHeader header{s_treeImageMagic, static_cast<std::uint32_t>(sizeof(T)), 0, 0}; // count is filled in by finish()
+        m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }                                                                                   // constructor end //
+
+    template <typename T>
+    void TreeImageWriter<T>::append(const T& value)                                     // append function start //
+    {
+        if(m_finished)
+            throw std::runtime_error{
+                "TreeImageWriter append(), image is already finished"};
+
+        if(m_count != 0 && !(m_last < value))
+            throw std::runtime_error{
+                "TreeImageWriter append(), values must be strictly increasing"};
+
+        if(m_buffer.size() == m_buffer.capacity())
+            flush();
+
+        m_buffer.push_back(value);
+        m_last = value;
+        ++m_count;
+    }                                                                                   // append function end //
+
+    template <typename T>
+    void TreeImageWriter<T>::finish()                                                   // finish function start //
+    {
+        if(m_finished)
+            return;
+
+        flush();
+
+        TreeImageHeader header{s_treeImageMagic, static_cast<std::uint32_t>(sizeof(T)), 0, m_count};
+        m_out.seekp(0);
+        m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_out.flush();
+        m_finished = true;
+
+        if(!m_out)
+            throw std::runtime_error{
+                "TreeImageWriter finish(), cannot write image"};
+    }                                                                                   // finish function end //
+
+    template <typename T>
+    void TreeImageWriter<T>::flush()                                                    // flush function start //
+    {
+        m_out.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size() * sizeof(T)));
+        m_buffer.clear();
+
+        if(!m_out)
+            throw std::runtime_error{
+                "TreeImageWriter flush(), cannot write image"};
+    }                                                                                   // flush function end //
+
+    template <class T, class Augmentation>
+    void writeTreeImage(const AVLTree<T, Augmentation>& tree, const std::string& path)
+    {                                                                                   // writeTreeImage function start //
+        TreeImageWriter<T> writer{path};
+
+        for(const T& value : tree)
+            writer.append(value);
+
+        writer.finish();
+    }                                                                                   // writeTreeImage function end //
+
+    template <class T>
+    std::uint64_t readTreeImageHeader(std::ifstream& in, const std::string& path)      // readTreeImageHeader function start //
+    {
+        TreeImageHeader header{};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if(!in || header.magic != s_treeImageMagic)
+            throw std::runtime_error{
+                "readTreeImageHeader(), " + path + " is not a tree image"};
+
+        if(header.valueSize != sizeof(T))
+            throw std::runtime_error{
+                "readTreeImageHeader(), " + path + " holds values of a different size"};
+
+        return header.count;
+    }                                                                                   // readTreeImageHeader function end //
+
+    template <class T, class Augmentation>
+    void readTreeImage(const std::string& path, AVLTree<T, Augmentation>& tree)
+    {                                                                                   // readTreeImage function start //
+        static_assert(std::is_trivially_copyable<T>::value, "readTreeImage reads raw bytes of T");
+
+        std::ifstream in{path, std::ios::binary};
+        if(!in)
+            throw std::runtime_error{
+                "readTreeImage(), cannot open " + path};
+
+        std::uint64_t count = readTreeImageHeader<T>(in, path);
+
+        std::vector<T> values(static_cast<std::size_t>(count));
+        in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(T)));
+
+        if(!in)
+            throw std::runtime_error{
+                "readTreeImage(), " + path + " is truncated"};
+
+        tree.buildSorted(values);                    // also rejects an image whose values are out of order
+    }                                                                                   // readTreeImage function end //
+}
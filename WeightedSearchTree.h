@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stack>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "AVLTree.h"
+
+namespace DataStructures
+{
+    // read only search tree shaped by how often each key is looked up, built in AVLTree's node format
+    // Mehlhorn's rule picks as every subtree's root the key that splits the subtree's weight most evenly,
+    // which keeps the expected number of visited nodes within a small constant of the entropy of the access profile
+    // the tree is not height balanced, so it is frozen after the build, there is no insert or remove
+    template <class T>
+    class WeightedSearchTree
+    {
+        typedef AVLTree<T, NoAugmentation> Tree;     // a frozen tree is never hashed, counted, checkpointed or adapted, so its nodes keep none of those fields
+        typedef typename Tree::Node Node;
+
+        Tree m_tree;                                 // owns the nodes, only its const interface is used after the build
+        std::vector<T> m_keys;                       // profile keys in order
+        std::vector<double> m_weights;               // weight of m_keys[i]
+
+        public:
+
+        typedef typename Tree::ConstIterator ConstIterator;
+
+        explicit WeightedSearchTree(std::vector<std::pair<T, double>> profile);  // builds the tree, weights of repeated keys are added up, throws on a negative weight
+        WeightedSearchTree(const WeightedSearchTree<T>&) = delete;              // copy constructor disabled
+
+        const T* find(const T& value) const { return m_tree.find(value); }      // trys to find an element, returns a pointer to it or nullptr
+        std::size_t searchDepth(const T& value) const { return m_tree.searchDepth(value); } // returns the number of nodes a search for the value visits
+
+        ConstIterator begin() const { return m_tree.begin(); }                  // returns an iterator to the smallest value
+        ConstIterator end() const { return m_tree.end(); }                      // returns the past the end iterator
+        ConstIterator lowerBound(const T& value) const { return m_tree.lowerBound(value); } // returns an iterator to the first value not less than value
+
+        bool empty() const { return m_tree.empty(); }                           // returns true if the tree is empty
+        std::size_t size() const { return m_tree.size(); }                      // returns the number of keys
+
+        double expectedPathLength() const { return expectedPathLength(m_tree); } // returns the weighted mean number of nodes visited by a search for a profile key
+        template <class Augmentation>
+        double expectedPathLength(const AVLTree<T, Augmentation>&) const;       // same measure over another tree holding the keys, e.g. an AVLTree of the same keys
+        double measuredPathLength(const std::vector<T>& accesses) const;        // returns the mean number of nodes visited while searching for every key of an access log
+    };
+
+    template <typename T>
+    WeightedSearchTree<T>::WeightedSearchTree(std::vector<std::pair<T, double>> profile) : m_tree{}, m_keys{}, m_weights{}
+    {                                                                                          // constructor start //
+        std::sort(profile.begin(), profile.end(),
+                  [](const std::pair<T, double>& a, const std::pair<T, double>& b) { return a.first < b.first; });
+
+        for(const std::pair<T, double>& entry : profile)
+        {
+            if(entry.second < 0)
+                throw std::runtime_error{
+                    "WeightedSearchTree WeightedSearchTree(), weights cannot be negative"};
+
+            if(!m_keys.empty() && !(m_keys.back() < entry.first))                               // repeated key, merge its weights
+                m_weights.back() += entry.second;
+            else
+            {
+                m_keys.push_back(entry.first);
+                m_weights.push_back(entry.second);
+            }
+        }
+
+        std::size_t count = m_keys.size();
+        if(count == 0)
+            return;
+
+        std::vector<double> prefix(count + 1, 0.0);                                             // prefix[i] is the weight of the first i keys
+        for(std::size_t i = 0; i < count; ++i)
+            prefix[i + 1] = prefix[i] + m_weights[i];
+
+        struct Range
+        {
+            std::size_t low;                         // keys [low, high) go below parent
+            std::size_t high;
+            Node* parent;
+            bool left;                               // side of parent the subtree hangs on
+        };
+
+        std::vector<Node*> built;                    // every node in build order, parents before their children
+        built.reserve(count);
+
+        std::stack<Range> ranges;                    // explicit stack, skewed profiles can make the tree as deep as it is wide
+        ranges.push(Range{0, count, nullptr, false});
+
+        while(!ranges.empty())
+        {
+            Range range = ranges.top();
+            ranges.pop();
+
+            double half = (prefix[range.low] + prefix[range.high]) / 2;                         // prefix value at which the weight is split evenly
+
+            std::size_t root = static_cast<std::size_t>(                                         // first key whose prefix including it reaches the middle
+                std::lower_bound(prefix.begin() + range.low + 1, prefix.begin() + range.high, half) - prefix.begin()) - 1;
+
+            auto imbalance = [&](std::size_t key)                                                // weight left of the key minus weight right of it, the key's own weight is in neither
+            {
+                double left = prefix[key] - prefix[range.low];
+                double right = prefix[range.high] - prefix[key + 1];
+                return left < right ? right - left : left - right;
+            };
+
+            if(root > range.low && imbalance(root - 1) < imbalance(root))                       // the key before splits its subtrees more evenly
+                --root;
+
+            if(prefix[range.high] == prefix[range.low])                                         // keys never accessed, balance them by count
+                root = (range.low + range.high) / 2;
+
+            Node* node = new Node{m_keys[root], range.parent};
+            built.push_back(node);
+
+            if(range.parent == nullptr)
+                m_tree.m_root = node;
+            else if(range.left)
+                range.parent->left = node;
+            else
+                range.parent->right = node;
+
+            if(root + 1 < range.high)
+                ranges.push(Range{root + 1, range.high, node, false});
+
+            if(range.low < root)
+                ranges.push(Range{range.low, root, node, true});
+        }
+
+        for(std::size_t i = built.size(); i-- > 0;)                                             // children come later, so heights are filled bottom up
+            m_tree.update(built[i]);
+
+        m_tree.m_size = count;
+        m_tree.relink();                                                                         // nodes were not built in order, link them for iteration
+    }                                                                                          // constructor end //
+
+    template <typename T>
+    template <class Augmentation>
+    double WeightedSearchTree<T>::expectedPathLength(const AVLTree<T, Augmentation>& tree) const
+    {                                                                                          // expectedPathLength function start //
+        double total = 0;
+        double weighted = 0;
+
+        for(std::size_t i = 0; i < m_keys.size(); ++i)
+        {
+            total += m_weights[i];
+            weighted += m_weights[i] * static_cast<double>(tree.searchDepth(m_keys[i]));
+        }
+
+        if(total == 0)
+            return 0;
+        return weighted / total;
+    }                                                                                          // expectedPathLength function end //
+
+    template <typename T>
+    double WeightedSearchTree<T>::measuredPathLength(const std::vector<T>& accesses) const   // measuredPathLength function start //
+    {
+        if(accesses.empty())
+            return 0;
+
+        double visited = 0;
+        for(const T& key : accesses)
+            visited += static_cast<double>(m_tree.searchDepth(key));
+
+        return visited / static_cast<double>(accesses.size());
+    }                                                                                          // measuredPathLength function end //
+}